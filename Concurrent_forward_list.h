@@ -0,0 +1,269 @@
+#ifndef CONCURRENT_FORWARD_LIST_H
+#define CONCURRENT_FORWARD_LIST_H
+
+#include <atomic>  // std::atomic
+#include <cstddef> // size_t
+#include <new>     // ::operator new, ::operator delete, placement new
+#include <utility> // std::forward, std::move
+
+#include "Forward_list.h" // include definition of class template FlistNode
+
+#if !defined(__cpp_lib_atomic_ref) && !defined(__GNUC__) && !defined(__clang__)
+#error "concurrent_forward_list needs std::atomic_ref (C++20) or the GCC/Clang __atomic builtins"
+#endif
+
+// Relaxed atomic load and store of FlistNode::next. A pop that lost the race
+// for the head may still read the next field of a node that is being pushed
+// again, so every access to it in concurrent_forward_list goes through these;
+// FlistNode itself keeps a plain pointer for forward_list.
+template< typename T >
+inline FlistNode< T > *loadNext(FlistNode< T > *node)
+{
+#if defined(__cpp_lib_atomic_ref)
+	return std::atomic_ref< FlistNode< T > * >(node->next).load(std::memory_order_relaxed);
+#else
+	return __atomic_load_n(&node->next, __ATOMIC_RELAXED);
+#endif
+}
+
+template< typename T >
+inline void storeNext(FlistNode< T > *node, FlistNode< T > *next)
+{
+#if defined(__cpp_lib_atomic_ref)
+	std::atomic_ref< FlistNode< T > * >(node->next).store(next, std::memory_order_relaxed);
+#else
+	__atomic_store_n(&node->next, next, __ATOMIC_RELAXED);
+#endif
+}
+
+// TaggedNodePtr class template definition
+// A node pointer paired with a counter that is bumped by every pop,
+// so a compare-and-swap fails if the head was popped and pushed back in between (ABA).
+// Lock-free only where double-width CAS is available (e.g. cmpxchg16b, -mcx16 / libatomic).
+template< typename T >
+struct alignas(2 * sizeof(void *)) TaggedNodePtr
+{
+	FlistNode< T > *ptr;
+	size_t tag;
+}; // end class template TaggedNodePtr
+
+
+// concurrent_forward_list class template definition
+// Lock-free LIFO stack (Treiber stack) of FlistNodes.
+// Popped nodes are recycled through an internal free list and only released
+// by the destructor, so a thread holding a stale head can always read its next field.
+// The head is a 16-byte TaggedNodePtr on 64-bit targets: build with -mcx16 on
+// x86-64 and link with -latomic, so the CAS is a cmpxchg16b. Without them the
+// 16-byte std::atomic may fall back to a lock. GCC's libatomic reports 16-byte
+// atomics as not lock-free even when it uses cmpxchg16b, so is_lock_free()
+// is only a reliable yes.
+template< typename T >
+class concurrent_forward_list
+{
+public:
+	concurrent_forward_list(); // Constructs an empty container.
+
+	// Destroys all elements and deallocates all nodes, including recycled ones.
+	// Must not run concurrently with any other member function.
+	~concurrent_forward_list();
+
+	concurrent_forward_list(const concurrent_forward_list &) = delete;
+	concurrent_forward_list& operator=(const concurrent_forward_list &) = delete;
+
+	// Returns a bool value indicating whether the container was empty
+	// at the time of the call.
+	bool empty() const;
+
+	// Inserts a new element at the beginning of the container.
+	void push_front(const T &val);
+	void push_front(T &&val);
+
+	// Inserts a new element constructed in place from args
+	// at the beginning of the container.
+	template< typename... Args >
+	void emplace_front(Args&&... args);
+
+	// Removes the first element and moves it into val.
+	// Returns false, leaving val untouched, if the container is empty.
+	bool pop_front(T &val);
+
+	// Atomically detaches the whole chain, then calls func on each element
+	// (moved, most recently pushed first) and recycles its node.
+	// Returns the number of elements removed.
+	template< typename Func >
+	size_t pop_all(Func func);
+
+	// Returns true if the head is updated without a lock.
+	bool is_lock_free() const;
+
+private:
+	alignas(64) std::atomic< TaggedNodePtr< T > > myHead; // first element
+	alignas(64) std::atomic< TaggedNodePtr< T > > myFree; // recycled nodes, myVal destroyed
+
+	// Pushes the chain [first, last] onto head.
+	static void pushChain(std::atomic< TaggedNodePtr< T > > &head,
+		FlistNode< T > *first, FlistNode< T > *last);
+
+	// Pops a single node from head, or returns nullptr if head is empty.
+	static FlistNode< T > *popNode(std::atomic< TaggedNodePtr< T > > &head);
+
+	// Returns a node whose myVal is unconstructed, recycled if possible.
+	FlistNode< T > *buyNode();
+
+	// Releases every node in the chain starting at node; destroys myVal if destroyVal.
+	static void freeChain(FlistNode< T > *node, bool destroyVal);
+}; // end class template concurrent_forward_list
+
+
+// Constructs an empty container.
+template< typename T >
+concurrent_forward_list< T >::concurrent_forward_list()
+	: myHead(TaggedNodePtr< T >{ nullptr, 0 }),
+	myFree(TaggedNodePtr< T >{ nullptr, 0 })
+{
+}
+
+// Destroys all elements and deallocates all nodes, including recycled ones.
+template< typename T >
+concurrent_forward_list< T >::~concurrent_forward_list()
+{
+	freeChain(myHead.load(std::memory_order_relaxed).ptr, true);
+	freeChain(myFree.load(std::memory_order_relaxed).ptr, false);
+}
+
+// Returns a bool value indicating whether the container was empty at the time of the call.
+template< typename T >
+bool concurrent_forward_list< T >::empty() const
+{
+	return myHead.load(std::memory_order_acquire).ptr == nullptr;
+}
+
+// Inserts a new element at the beginning of the container.
+template< typename T >
+void concurrent_forward_list< T >::push_front(const T &val)
+{
+	emplace_front(val);
+}
+
+template< typename T >
+void concurrent_forward_list< T >::push_front(T &&val)
+{
+	emplace_front(std::move(val));
+}
+
+// Inserts a new element constructed in place from args at the beginning of the container.
+template< typename T >
+template< typename... Args >
+void concurrent_forward_list< T >::emplace_front(Args&&... args)
+{
+	FlistNode< T > *newNode = buyNode();
+	try
+	{
+		::new (static_cast< void * >(&newNode->myVal)) T(std::forward< Args >(args)...);
+	}
+	catch (...)
+	{
+		pushChain(myFree, newNode, newNode);
+		throw;
+	}
+
+	pushChain(myHead, newNode, newNode);
+}
+
+// Removes the first element and moves it into val.
+template< typename T >
+bool concurrent_forward_list< T >::pop_front(T &val)
+{
+	FlistNode< T > *node = popNode(myHead);
+	if (node == nullptr)
+		return false;
+
+	val = std::move(node->myVal);
+	node->myVal.~T();
+	pushChain(myFree, node, node);
+	return true;
+}
+
+// Atomically detaches the whole chain, then hands each element to func.
+template< typename T >
+template< typename Func >
+size_t concurrent_forward_list< T >::pop_all(Func func)
+{
+	TaggedNodePtr< T > oldHead = myHead.load(std::memory_order_relaxed);
+	while (!myHead.compare_exchange_weak(oldHead, TaggedNodePtr< T >{ nullptr, oldHead.tag + 1 },
+		std::memory_order_acquire, std::memory_order_relaxed))
+		;
+
+	FlistNode< T > *first = oldHead.ptr;
+	FlistNode< T > *last = nullptr;
+	size_t count = 0;
+	for (FlistNode< T > *p = first; p != nullptr; p = loadNext(p), count++)
+	{
+		func(std::move(p->myVal));
+		p->myVal.~T();
+		last = p;
+	}
+
+	if (first != nullptr)
+		pushChain(myFree, first, last);
+	return count;
+}
+
+// Returns true if the head is updated without a lock.
+template< typename T >
+bool concurrent_forward_list< T >::is_lock_free() const
+{
+	return myHead.is_lock_free();
+}
+
+// Pushes the chain [first, last] onto head.
+// A push never needs a new tag: replacing the head is safe even if it was recycled.
+template< typename T >
+void concurrent_forward_list< T >::pushChain(std::atomic< TaggedNodePtr< T > > &head,
+	FlistNode< T > *first, FlistNode< T > *last)
+{
+	TaggedNodePtr< T > oldHead = head.load(std::memory_order_relaxed);
+	do
+		storeNext(last, oldHead.ptr);
+	while (!head.compare_exchange_weak(oldHead, TaggedNodePtr< T >{ first, oldHead.tag },
+		std::memory_order_release, std::memory_order_relaxed));
+}
+
+// Pops a single node from head, or returns nullptr if head is empty.
+template< typename T >
+FlistNode< T > *concurrent_forward_list< T >::popNode(std::atomic< TaggedNodePtr< T > > &head)
+{
+	TaggedNodePtr< T > oldHead = head.load(std::memory_order_acquire);
+	while (oldHead.ptr != nullptr &&
+		!head.compare_exchange_weak(oldHead, TaggedNodePtr< T >{ loadNext(oldHead.ptr), oldHead.tag + 1 },
+			std::memory_order_acquire, std::memory_order_acquire))
+		;
+
+	return oldHead.ptr;
+}
+
+// Returns a node whose myVal is unconstructed, recycled if possible.
+template< typename T >
+FlistNode< T > *concurrent_forward_list< T >::buyNode()
+{
+	FlistNode< T > *node = popNode(myFree);
+	if (node == nullptr)
+		node = static_cast< FlistNode< T > * >(::operator new(sizeof(FlistNode< T >)));
+	return node;
+}
+
+// Releases every node in the chain starting at node; destroys myVal if destroyVal.
+template< typename T >
+void concurrent_forward_list< T >::freeChain(FlistNode< T > *node, bool destroyVal)
+{
+	while (node != nullptr)
+	{
+		FlistNode< T > *temp = node;
+		node = loadNext(node);
+		if (destroyVal)
+			temp->myVal.~T();
+		::operator delete(temp);
+	}
+}
+
+#endif
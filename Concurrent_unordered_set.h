@@ -0,0 +1,691 @@
+#ifndef CONCURRENT_UNORDERED_SET_H
+#define CONCURRENT_UNORDERED_SET_H
+
+#include <atomic>     // std::atomic, std::atomic_thread_fence
+#include <cstddef>    // size_t
+#include <cstdint>    // uint64_t
+#include <functional> // std::equal_to
+#include <mutex>      // std::mutex, std::lock_guard, std::unique_lock
+#include <utility>    // std::forward, std::move
+
+#include "Hash.h" // fast_hash
+
+// Epoch-based reclamation shared by every concurrent_unordered_set.
+// A reader announces the global epoch in its thread's slot for as long as it
+// walks a table; that slot sits on its own cache line and no other thread
+// writes it. A writer tags what it unlinks with the epoch current after the
+// unlink, and frees it once the epoch has moved on by two. The epoch only
+// advances when every announced reader has caught up with it, so nothing is
+// freed under a reader, yet a stream of short reads never holds it back.
+struct EpochSlot
+{
+	alignas(64) std::atomic< uint64_t > epoch{ 0 }; // announced epoch, 0 if outside
+	std::atomic< bool > owned{ true };             // held by a live thread
+	unsigned int depth = 0;                         // nested guards, owner only
+	EpochSlot *next = nullptr;                      // next slot of the registry
+};
+
+class Epoch
+{
+public:
+	// Returns the epoch to tag what was unlinked before the call with.
+	static uint64_t current()
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		return global.load(std::memory_order_seq_cst);
+	}
+
+	// Advances the epoch if every announced reader has caught up with it.
+	// The epoch is read before the fence, so a reader that announced it too
+	// late for the scan below to see has already read a later unlink.
+	static void tryAdvance()
+	{
+		uint64_t e = global.load(std::memory_order_seq_cst);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		for (EpochSlot *slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+		{
+			uint64_t announced = slot->epoch.load(std::memory_order_acquire);
+			if (announced != 0 && announced != e)
+				return;
+		}
+		global.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+	}
+
+	// Returns the slot of the calling thread, taking a free one on first use.
+	static EpochSlot &mySlot()
+	{
+		thread_local SlotOwner owner;
+		if (owner.slot == nullptr)
+			owner.slot = acquireSlot();
+		return *owner.slot;
+	}
+
+	// Announces the current epoch in slot. The seq_cst exchange orders the
+	// announcement before the caller's seq_cst loads; on x86 it is one xchg on
+	// the slot's own line, cheaper than a store and a fence. The epoch is read
+	// again afterwards, so the announced value is one the epoch still had once
+	// the announcement was visible to writers.
+	static void enter(EpochSlot &slot)
+	{
+		uint64_t e = global.load(std::memory_order_seq_cst);
+		for (;;)
+		{
+			slot.epoch.exchange(e, std::memory_order_seq_cst);
+			uint64_t now = global.load(std::memory_order_seq_cst);
+			if (now == e)
+				return;
+			e = now;
+		}
+	}
+
+	// Withdraws the announcement of slot; pairs with the acquire scan in tryAdvance.
+	static void leave(EpochSlot &slot)
+	{
+		slot.epoch.store(0, std::memory_order_release);
+	}
+
+private:
+	// Gives the slot back when its thread exits.
+	struct SlotOwner
+	{
+		EpochSlot *slot = nullptr;
+
+		~SlotOwner()
+		{
+			if (slot != nullptr)
+				slot->owned.store(false, std::memory_order_release);
+		}
+	};
+
+	// Returns a slot no live thread holds; slots are reused but never freed.
+	static EpochSlot *acquireSlot()
+	{
+		for (EpochSlot *slot = slots.load(std::memory_order_acquire); slot != nullptr; slot = slot->next)
+			if (!slot->owned.load(std::memory_order_relaxed)
+				&& !slot->owned.exchange(true, std::memory_order_acquire))
+				return slot;
+
+		EpochSlot *slot = new EpochSlot;
+		slot->next = slots.load(std::memory_order_relaxed);
+		while (!slots.compare_exchange_weak(slot->next, slot,
+			std::memory_order_release, std::memory_order_relaxed))
+			;
+		return slot;
+	}
+
+	static inline std::atomic< uint64_t > global{ 1 };          // the epoch, never 0
+	static inline std::atomic< EpochSlot * > slots{ nullptr };  // registry of every slot
+};
+
+// Keeps the calling thread's announcement for its lifetime; guards may nest.
+class EpochGuard
+{
+public:
+	EpochGuard()
+		: slot(Epoch::mySlot())
+	{
+		if (slot.depth++ == 0)
+			Epoch::enter(slot);
+	}
+
+	~EpochGuard()
+	{
+		if (--slot.depth == 0)
+			Epoch::leave(slot);
+	}
+
+	EpochGuard(const EpochGuard &) = delete;
+	EpochGuard& operator=(const EpochGuard &) = delete;
+
+private:
+	EpochSlot &slot;
+};
+
+// concurrent_unordered_set class template definition
+// Hash set for many threads. The high bits of a key's hash pick one of
+// shard_count() shards; each shard is an independent table whose writers take
+// the shard's mutex, while contains takes no lock at all.
+// A shard keeps its elements in one list sorted by bit-reversed hash, so that
+// each bucket is a run of the list that starts at a dummy link of its own
+// (a split-ordered list); the dummies are the bucket array itself. Readers
+// walk the list through atomic links from their bucket's dummy and stop at the
+// first larger key. Doubling the buckets swaps each old dummy for its copy in
+// the new array and links the new buckets' dummies into the middle of the old
+// runs; no element moves, and a reader still on an old dummy follows it back
+// into the list.
+// A writer never changes a link a reader may need: erase unlinks a node, and
+// an old dummy keeps its next. Unlinked nodes and old bucket arrays are
+// retired to the shard, tagged with the epoch (see Epoch above), and freed by
+// a later writer of the shard once no reader can still reach them. A contains
+// writes nothing but its thread's own epoch slot.
+template< typename T, typename Hash = fast_hash< T >, typename KeyEqual = std::equal_to< T > >
+class concurrent_unordered_set
+{
+public:
+	// Constructs an empty container of shards shards, rounded up to a power of 2.
+	explicit concurrent_unordered_set(size_t shards = 64,
+		const Hash &hash = Hash(), const KeyEqual &equal = KeyEqual());
+
+	// Destroys all elements and frees everything retired.
+	// Must not run concurrently with any other member function.
+	~concurrent_unordered_set();
+
+	concurrent_unordered_set(const concurrent_unordered_set &) = delete;
+	concurrent_unordered_set& operator=(const concurrent_unordered_set &) = delete;
+
+	// Inserts val unless an equal element is present.
+	// Returns true if val was inserted.
+	bool insert(const T &val);
+	bool insert(T &&val);
+
+	// Inserts an element constructed in place from args unless an equal
+	// element is present. The element is constructed before the check.
+	template< typename... Args >
+	bool emplace(Args&&... args);
+
+	// Removes the element equal to k. Returns true if there was one.
+	bool erase(const T &k);
+
+	// Returns true if an element equal to k was present at the time of the call.
+	// Never blocks.
+	bool contains(const T &k) const;
+
+	// Returns the number of elements; approximate while other threads write.
+	size_t size() const;
+
+	// Returns the number of shards.
+	size_t shard_count() const;
+
+private:
+	// A link of a shard's list: a bucket's dummy, or the base of a Node.
+	struct Link
+	{
+		std::atomic< Link * > next; // next link of the list, read by readers
+		size_t key;                 // odd for a node, even for a dummy; see nodeKey
+
+		explicit Link(size_t k = 0)
+			: next(nullptr), key(k)
+		{
+		}
+	};
+
+	struct Node : Link
+	{
+		Node *retiredNext; // next node of the retired list
+		T myVal;
+
+		template< typename... Args >
+		Node(size_t k, Args&&... args)
+			: Link(k), retiredNext(nullptr), myVal(std::forward< Args >(args)...)
+		{
+		}
+	};
+
+	struct Table
+	{
+		size_t mask;        // bucket count - 1, a power of 2 minus 1
+		Link *buckets;      // dummy of each bucket
+		Table *retiredNext; // next table of the retired list
+	};
+
+	// What a shard retired during one epoch.
+	struct Bag
+	{
+		uint64_t epoch = 0;
+		Node *nodes = nullptr;
+		Table *tables = nullptr;
+	};
+
+	struct alignas(64) Shard
+	{
+		std::atomic< Table * > table{ nullptr };
+		std::atomic< size_t > count{ 0 };  // elements, written under lock
+
+		std::mutex lock;                   // guards everything below and all writes
+		Bag retired[3];                    // indexed by epoch % 3
+		size_t retiredSinceAdvance = 0;    // retirements since the last tryAdvance
+	};
+
+	// retirements between two attempts to advance the epoch
+	static const size_t advanceEvery = 64;
+
+	Shard *shards;
+	size_t shardBits; // log2 of the shard count
+
+	Hash myHash;      // hash function object
+	KeyEqual myEqual; // key equality function object
+
+	// Returns the shard of hash h, chosen by its high bits; the low bits pick
+	// the bucket inside the shard.
+	Shard &shardOf(size_t h) const;
+
+	// Returns x with its bits in reverse order.
+	static size_t reverseBits(size_t x);
+
+	// Returns the list key of an element of hash h: its bit-reversed hash with
+	// the lowest bit set, which sorts it after the dummy of its bucket.
+	static size_t nodeKey(size_t h);
+
+	// Inserts an element built from args unless one equal to key is present.
+	template< typename... Args >
+	bool insertKey(const T &key, Args&&... args);
+
+	// Returns the node of s holding k, whose hash is h, or nullptr; s is locked.
+	// Sets prev to the link the node follows, or the one a new node of hash h
+	// would follow.
+	Node *findLocked(Shard &s, size_t h, const T &k, Link *&prev) const;
+
+	// Grows the table of s, whose lock is held, if it has no room for one more element.
+	void reserveLocked(Shard &s);
+
+	// Links node into s, whose lock is held, right after prev.
+	static void linkLocked(Shard &s, Link *prev, Node *node);
+
+	// Returns a new table of buckets buckets whose dummies are not linked yet.
+	static Table *newTable(size_t buckets);
+
+	// Replaces the table of s, whose lock is held, by one twice as large.
+	void grow(Shard &s);
+
+	// Returns the bag of s, whose lock is held, for what was unlinked before
+	// the call, first freeing the bags no reader can reach any more.
+	static Bag &retireBag(Shard &s);
+
+	// Frees the nodes and tables in bag.
+	static void freeBag(Bag &bag);
+}; // end class template concurrent_unordered_set
+
+
+// Constructs an empty container of shards shards, each with 8 buckets.
+template< typename T, typename Hash, typename KeyEqual >
+concurrent_unordered_set< T, Hash, KeyEqual >::concurrent_unordered_set(size_t count,
+	const Hash &hash, const KeyEqual &equal)
+	: shards(nullptr),
+	shardBits(0),
+	myHash(hash),
+	myEqual(equal)
+{
+	while ((size_t(1) << shardBits) < count && shardBits + 1 < sizeof(size_t) * 8)
+		shardBits++;
+
+	shards = new Shard[shard_count()];
+	try
+	{
+		for (size_t i = 0; i < shard_count(); i++)
+		{	// with no elements, the dummy of b + half follows that of b
+			Table *t = newTable(8);
+			for (size_t half = 1; half < 8; half *= 2)
+				for (size_t b = 0; b < half; b++)
+				{
+					t->buckets[b + half].next.store(t->buckets[b].next.load(std::memory_order_relaxed),
+						std::memory_order_relaxed);
+					t->buckets[b].next.store(&t->buckets[b + half], std::memory_order_relaxed);
+				}
+			shards[i].table.store(t, std::memory_order_relaxed);
+		}
+	}
+	catch (...)
+	{
+		for (size_t i = 0; i < shard_count(); i++)
+		{
+			Table *t = shards[i].table.load(std::memory_order_relaxed);
+			if (t != nullptr)
+			{
+				delete[] t->buckets;
+				delete t;
+			}
+		}
+		delete[] shards;
+		throw;
+	}
+}
+
+// Destroys all elements and frees everything retired.
+template< typename T, typename Hash, typename KeyEqual >
+concurrent_unordered_set< T, Hash, KeyEqual >::~concurrent_unordered_set()
+{
+	for (size_t i = 0; i < shard_count(); i++)
+	{
+		Shard &s = shards[i];
+		for (Bag &bag : s.retired)
+			freeBag(bag);
+
+		Table *t = s.table.load(std::memory_order_relaxed);
+		Link *link = t->buckets[0].next.load(std::memory_order_relaxed);
+		while (link != nullptr)
+		{
+			Link *temp = link;
+			link = link->next.load(std::memory_order_relaxed);
+			if (temp->key & 1)
+				delete static_cast< Node * >(temp);
+		}
+		delete[] t->buckets;
+		delete t;
+	}
+	delete[] shards;
+}
+
+// Inserts val unless an equal element is present.
+template< typename T, typename Hash, typename KeyEqual >
+bool concurrent_unordered_set< T, Hash, KeyEqual >::insert(const T &val)
+{
+	return insertKey(val, val);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+bool concurrent_unordered_set< T, Hash, KeyEqual >::insert(T &&val)
+{
+	return insertKey(val, std::move(val));
+}
+
+// Inserts an element constructed in place from args unless an equal element is present.
+template< typename T, typename Hash, typename KeyEqual >
+template< typename... Args >
+bool concurrent_unordered_set< T, Hash, KeyEqual >::emplace(Args&&... args)
+{
+	Node *node = new Node(0, std::forward< Args >(args)...);
+	size_t h;
+	try
+	{
+		h = myHash(node->myVal);
+	}
+	catch (...)
+	{
+		delete node;
+		throw;
+	}
+	node->key = nodeKey(h);
+
+	Shard &s = shardOf(h);
+	{
+		std::unique_lock< std::mutex > guard(s.lock);
+		Link *prev;
+		Node *found;
+		try
+		{
+			reserveLocked(s);
+			found = findLocked(s, h, node->myVal, prev);
+		}
+		catch (...)
+		{
+			guard.unlock();
+			delete node;
+			throw;
+		}
+
+		if (found == nullptr)
+		{
+			linkLocked(s, prev, node);
+			return true;
+		}
+	}
+	delete node;
+	return false;
+}
+
+// Removes the element equal to k.
+template< typename T, typename Hash, typename KeyEqual >
+bool concurrent_unordered_set< T, Hash, KeyEqual >::erase(const T &k)
+{
+	size_t h = myHash(k);
+	Shard &s = shardOf(h);
+	std::lock_guard< std::mutex > guard(s.lock);
+
+	Link *prev;
+	Node *node = findLocked(s, h, k, prev);
+	if (node == nullptr)
+		return false;
+
+	// a reader on node still finds the rest of the list through node->next
+	prev->next.store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+	s.count.store(s.count.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+	Bag &bag = retireBag(s);
+	node->retiredNext = bag.nodes;
+	bag.nodes = node;
+	return true;
+}
+
+// Returns true if an element equal to k was present at the time of the call.
+// The loads are seq_cst so that they follow the guard's announcement: either a
+// writer sees this reader and keeps its garbage, or this reader sees its
+// unlinks. On x86 they are plain moves.
+template< typename T, typename Hash, typename KeyEqual >
+bool concurrent_unordered_set< T, Hash, KeyEqual >::contains(const T &k) const
+{
+	size_t h = myHash(k);
+	size_t key = nodeKey(h);
+	Shard &s = shardOf(h);
+	EpochGuard guard;
+
+	Table *t = s.table.load(std::memory_order_seq_cst);
+	for (Link *link = t->buckets[h & t->mask].next.load(std::memory_order_seq_cst);
+		link != nullptr && link->key <= key; link = link->next.load(std::memory_order_seq_cst))
+		if (link->key == key && myEqual(static_cast< Node * >(link)->myVal, k))
+			return true;
+	return false;
+}
+
+// Returns the number of elements; approximate while other threads write.
+template< typename T, typename Hash, typename KeyEqual >
+size_t concurrent_unordered_set< T, Hash, KeyEqual >::size() const
+{
+	size_t total = 0;
+	for (size_t i = 0; i < shard_count(); i++)
+		total += shards[i].count.load(std::memory_order_relaxed);
+	return total;
+}
+
+// Returns the number of shards.
+template< typename T, typename Hash, typename KeyEqual >
+size_t concurrent_unordered_set< T, Hash, KeyEqual >::shard_count() const
+{
+	return size_t(1) << shardBits;
+}
+
+// Returns the shard of hash h, chosen by its high bits.
+template< typename T, typename Hash, typename KeyEqual >
+typename concurrent_unordered_set< T, Hash, KeyEqual >::Shard &
+concurrent_unordered_set< T, Hash, KeyEqual >::shardOf(size_t h) const
+{
+	if (shardBits == 0)
+		return shards[0];
+	return shards[h >> (sizeof(size_t) * 8 - shardBits)];
+}
+
+// Returns x with its bits in reverse order, swapping halves of ever smaller width.
+template< typename T, typename Hash, typename KeyEqual >
+size_t concurrent_unordered_set< T, Hash, KeyEqual >::reverseBits(size_t x)
+{
+	size_t mask = ~size_t(0);
+	for (size_t width = sizeof(size_t) * 8 / 2; width > 0; width /= 2)
+	{
+		mask ^= mask << width;
+		x = ((x >> width) & mask) | ((x << width) & ~mask);
+	}
+	return x;
+}
+
+// Returns the list key of an element of hash h.
+// The dummy of bucket b has key reverseBits(b), which is even since b never
+// uses the top bit; the elements of b follow it because their keys share its
+// high bits and are odd.
+template< typename T, typename Hash, typename KeyEqual >
+size_t concurrent_unordered_set< T, Hash, KeyEqual >::nodeKey(size_t h)
+{
+	return reverseBits(h) | 1;
+}
+
+// Inserts an element built from args unless one equal to key is present.
+// The node is only allocated once the key is known to be missing.
+template< typename T, typename Hash, typename KeyEqual >
+template< typename... Args >
+bool concurrent_unordered_set< T, Hash, KeyEqual >::insertKey(const T &key, Args&&... args)
+{
+	size_t h = myHash(key);
+	Shard &s = shardOf(h);
+	std::lock_guard< std::mutex > guard(s.lock);
+	reserveLocked(s);
+
+	Link *prev;
+	if (findLocked(s, h, key, prev) != nullptr)
+		return false;
+
+	linkLocked(s, prev, new Node(nodeKey(h), std::forward< Args >(args)...));
+	return true;
+}
+
+// Returns the node of s holding k, whose hash is h, or nullptr.
+template< typename T, typename Hash, typename KeyEqual >
+typename concurrent_unordered_set< T, Hash, KeyEqual >::Node *
+concurrent_unordered_set< T, Hash, KeyEqual >::findLocked(Shard &s, size_t h, const T &k,
+	Link *&prev) const
+{
+	size_t key = nodeKey(h);
+	Table *t = s.table.load(std::memory_order_relaxed);
+	prev = &t->buckets[h & t->mask];
+	for (Link *link = prev->next.load(std::memory_order_relaxed); link != nullptr && link->key <= key;
+		prev = link, link = link->next.load(std::memory_order_relaxed))
+		if (link->key == key && myEqual(static_cast< Node * >(link)->myVal, k))
+			return static_cast< Node * >(link);
+	return nullptr;
+}
+
+// Grows the table of s if it has no room for one more element.
+// This comes before the lookup, as growing may link a dummy right after the
+// link the lookup would return.
+template< typename T, typename Hash, typename KeyEqual >
+void concurrent_unordered_set< T, Hash, KeyEqual >::reserveLocked(Shard &s)
+{
+	if (s.count.load(std::memory_order_relaxed) > s.table.load(std::memory_order_relaxed)->mask)
+		grow(s);
+}
+
+// Links node into s right after prev.
+// The node is fully built before it is published with a release store.
+template< typename T, typename Hash, typename KeyEqual >
+void concurrent_unordered_set< T, Hash, KeyEqual >::linkLocked(Shard &s, Link *prev, Node *node)
+{
+	node->next.store(prev->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	prev->next.store(node, std::memory_order_release);
+	s.count.store(s.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Returns a new table of buckets buckets whose dummies are not linked yet.
+template< typename T, typename Hash, typename KeyEqual >
+typename concurrent_unordered_set< T, Hash, KeyEqual >::Table *
+concurrent_unordered_set< T, Hash, KeyEqual >::newTable(size_t buckets)
+{
+	Link *array = new Link[buckets];
+	for (size_t b = 0; b < buckets; b++)
+		array[b].key = reverseBits(b);
+
+	try
+	{
+		return new Table{ buckets - 1, array, nullptr };
+	}
+	catch (...)
+	{
+		delete[] array;
+		throw;
+	}
+}
+
+// Replaces the table of s by one twice as large.
+// One walk of the list, which visits the runs in key order, replaces each old
+// dummy by its copy and links the dummy of bucket b + half into the run of b,
+// right before its first element whose hash has bit half set: those elements
+// have the larger keys of the run. Each new link gets its next before it is
+// published, so a reader anywhere on the list always sees a sorted list; the
+// old dummies keep their next and are retired with the old array.
+template< typename T, typename Hash, typename KeyEqual >
+void concurrent_unordered_set< T, Hash, KeyEqual >::grow(Shard &s)
+{
+	Table *oldTable = s.table.load(std::memory_order_relaxed);
+	size_t half = oldTable->mask + 1;
+	Table *t = newTable(2 * half);
+
+	Link *tail = &t->buckets[0];  // last link of the walk so far
+	tail->next.store(oldTable->buckets[0].next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	Link *upper = &t->buckets[half]; // dummy still to link into the current run
+	for (;;)
+	{
+		Link *link = tail->next.load(std::memory_order_relaxed);
+		if (upper != nullptr && (link == nullptr || !(link->key & 1) || link->key > upper->key))
+		{
+			upper->next.store(link, std::memory_order_relaxed);
+			tail->next.store(upper, std::memory_order_release);
+			tail = upper;
+			upper = nullptr;
+		}
+
+		if (link == nullptr)
+			break;
+		if (link->key & 1)
+		{
+			tail = link;
+			continue;
+		}
+
+		// an old dummy starts the next run
+		size_t b = static_cast< size_t >(link - oldTable->buckets);
+		Link *dummy = &t->buckets[b];
+		dummy->next.store(link->next.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		tail->next.store(dummy, std::memory_order_release);
+		tail = dummy;
+		upper = &t->buckets[b + half];
+	}
+	s.table.store(t, std::memory_order_release);
+
+	Bag &bag = retireBag(s);
+	oldTable->retiredNext = bag.tables;
+	bag.tables = oldTable;
+	Epoch::tryAdvance();
+}
+
+// Returns the bag of s for what was unlinked before the call.
+// Tagged with epoch e, it is freed once the epoch reaches e + 2: the bag of
+// e + 1 modulo 3 was last tagged e - 2 or earlier, and the bag of e is reused
+// only when its tag is e - 3 or earlier.
+template< typename T, typename Hash, typename KeyEqual >
+typename concurrent_unordered_set< T, Hash, KeyEqual >::Bag &
+concurrent_unordered_set< T, Hash, KeyEqual >::retireBag(Shard &s)
+{
+	uint64_t e = Epoch::current();
+	freeBag(s.retired[(e + 1) % 3]);
+
+	Bag &bag = s.retired[e % 3];
+	if (bag.epoch != e)
+	{
+		freeBag(bag);
+		bag.epoch = e;
+	}
+
+	if (++s.retiredSinceAdvance == advanceEvery)
+	{
+		s.retiredSinceAdvance = 0;
+		Epoch::tryAdvance();
+	}
+	return bag;
+}
+
+// Frees the nodes and tables in bag.
+template< typename T, typename Hash, typename KeyEqual >
+void concurrent_unordered_set< T, Hash, KeyEqual >::freeBag(Bag &bag)
+{
+	while (bag.nodes != nullptr)
+	{
+		Node *temp = bag.nodes;
+		bag.nodes = temp->retiredNext;
+		delete temp;
+	}
+
+	while (bag.tables != nullptr)
+	{
+		Table *temp = bag.tables;
+		bag.tables = temp->retiredNext;
+		delete[] temp->buckets;
+		delete temp;
+	}
+}
+
+#endif
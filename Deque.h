@@ -1,10 +1,40 @@
 #ifndef DEQUE_H
 #define DEQUE_H
 
+#include <algorithm> // std::copy, std::equal, std::find, std::move
+#include <cstddef>   // size_t, ptrdiff_t
+#include <iterator>  // std::random_access_iterator_tag, std::make_move_iterator
+#include <memory>    // std::uninitialized_copy, std::uninitialized_fill
+#include <new>       // ::operator new, ::operator delete, placement new
+#include <type_traits> // std::is_trivially_destructible
+#include <utility>   // std::forward, std::move
+#include <vector>    // std::vector
+
+// Returns the largest power of 2 not greater than n (n > 0).
+constexpr size_t dequeFloorPow2(size_t n)
+{
+	return n < 2 ? 1 : 2 * dequeFloorPow2(n / 2);
+}
+
+// Returns log2(n) for a power of 2 n.
+constexpr size_t dequeLog2(size_t n)
+{
+	return n < 2 ? 0 : 1 + dequeLog2(n / 2);
+}
+
+// Default number of elements per deque block:
+// the largest power of 2 that keeps a block within 1 KB, but at least 1.
+template< class Ty >
+struct DequeBlockSize
+{
+	static const size_t value = dequeFloorPow2(sizeof(Ty) < 1024 ? 1024 / sizeof(Ty) : 1);
+};
+
 template< class BidIt >
 class ReverseIterator // wrap iterator to run it backwards
 {
 public:
+	using iterator_category = typename BidIt::iterator_category;
 	using value_type      = typename BidIt::value_type;
 	using difference_type = typename BidIt::difference_type;
 	using pointer         = typename BidIt::pointer;
@@ -168,6 +198,7 @@ private:
 	using size_type = typename MyDeque::size_type;
 
 public:
+	using iterator_category = std::random_access_iterator_tag;
 	using value_type      = typename MyDeque::value_type;
 	using difference_type = typename MyDeque::difference_type;
 	using pointer         = typename MyDeque::const_pointer;
@@ -210,9 +241,8 @@ public:
 
 	reference operator*() const
 	{
-		//      size_type block = myOff % ( 4 * myCont->mapSize ) / 4;
 		size_type block = myCont->getBlock(myOff);
-		size_type off = myOff % 4;
+		size_type off = myOff & MyDeque::blockMask;
 		return myCont->map[block][off];
 	}
 
@@ -335,6 +365,7 @@ private:
 	using MyBase = DequeConstIterator< MyDeque >;
 
 public:
+	using iterator_category = std::random_access_iterator_tag;
 	using value_type      = typename MyDeque::value_type;
 	using difference_type = typename MyDeque::difference_type;
 	using pointer         = typename MyDeque::pointer;
@@ -422,9 +453,11 @@ public:
 };
 
 
-template < class Ty >
+template < class Ty, size_t BlockSize >
 struct DequeSimpleTypes // wraps types needed by iterators
 {
+	static const size_t blockSize = BlockSize; // elements per block, a power of 2
+
 	using value_type      = Ty;
 	using size_type       = size_t;
 	using difference_type = ptrdiff_t;
@@ -447,6 +480,12 @@ public:
 	using const_reference = const value_type &;
 	using MapPtr          = typename ValTypes::MapPtr;
 
+	static const size_type blockSize  = ValTypes::blockSize;     // elements per block
+	static const size_type blockShift = dequeLog2(blockSize);   // log2(blockSize)
+	static const size_type blockMask  = blockSize - 1;          // offset within block
+
+	static_assert((blockSize & blockMask) == 0, "deque block size must be a power of 2");
+
 	DequeVal() // initialize values
 		: map(),
 		mapSize(0),
@@ -458,8 +497,7 @@ public:
 	// determine block from offset
 	size_type getBlock(size_type off) const
 	{
-		return off % (4 * mapSize) / 4;
-		//      return ( off / 4 ) & ( mapSize - 1 );
+		return (off >> blockShift) & (mapSize - 1);
 	}
 
 	MapPtr map;        // pointer to array of pointers to blocks
@@ -470,12 +508,18 @@ public:
 
 
 // CLASS TEMPLATE deque
-template< class Ty >
+// BlockSize, the number of elements per block, defaults to DequeBlockSize< Ty >
+// and must be a power of 2, so that all index math is shifts and masks.
+template< class Ty, size_t BlockSize = DequeBlockSize< Ty >::value >
 class deque // circular queue of pointers to blocks
 {
 private:
 	using MapPtr = Ty * *;
-	using ScaryVal = DequeVal< DequeSimpleTypes< Ty > >;
+	using ScaryVal = DequeVal< DequeSimpleTypes< Ty, BlockSize > >;
+
+	static const size_t blockSize  = ScaryVal::blockSize;
+	static const size_t blockShift = ScaryVal::blockShift;
+	static const size_t blockMask  = ScaryVal::blockMask;
 
 public:
 	using value_type      = Ty;
@@ -502,51 +546,43 @@ public:
 	deque(size_type count, const Ty& val)
 		: myData()
 	{
-		if (count == 0)
+		try
 		{
-			myData.map = nullptr;
-			myData.mapSize = 0;
+			appendN(count, val);
 		}
-		else
+		catch (...)
 		{
-			myData.mapSize = 8;
-			while (count > 4 * (myData.mapSize - 1))
-				myData.mapSize *= 2;
-
-			myData.map = new Ty * [myData.mapSize]();
-			for (size_type i = 0; i <= (count - 1) / 4; i++)
-				myData.map[i] = new Ty[4];
-
-			for (size_type i = 0; i < count; i++)
-				myData.map[i / 4][i % 4] = val;
+			tidy();
+			throw;
 		}
-		myData.mySize = count;
 	}
 
-	// construct by copying right
+	// construct by copying right; only the blocks the elements need are allocated
 	deque(const deque& right)
 		: myData()
 	{
-		myData.mapSize = right.myData.mapSize;
-		myData.map = new Ty * [myData.mapSize]();
-		myData.myOff = right.myData.myOff;
-		myData.mySize = right.myData.mySize;
-
-		for (int i = 0; i < myData.mapSize; i++)
-			if (right.myData.map[i] != nullptr)
-				myData.map[i] = new Ty[4]();
-
-		iterator p1 = this->begin();
-		const_iterator p2 = right.begin();
+		try
+		{
+			appendDeque(right);
+		}
+		catch (...)
+		{
+			tidy();
+			throw;
+		}
+	}
 
-		for (; p2 != right.end(); ++p1, ++p2)
-			* p1 = *p2;
+	// construct by moving right; steals its map, right is left empty
+	deque(deque&& right) noexcept
+		: myData()
+	{
+		takeMap(right);
 	}
 
 	// destroy the deque
 	~deque()
 	{
-		clear();
+		tidy();
 	}
 
 	// Assigns new contents to the container, replacing its current contents,
@@ -555,27 +591,25 @@ public:
 	{
 		if (&right != this) // avoid self-assignment
 		{
-			clear();
-
-			myData.mapSize = right.myData.mapSize;
-			myData.map = new Ty * [myData.mapSize]();
-			myData.myOff = right.myData.myOff;
-			myData.mySize = right.myData.mySize;
-
-			for (int i = 0; i < myData.mapSize; i++)
-				if (right.myData.map[i] != nullptr)
-					myData.map[i] = new Ty[4]();
-
-			iterator p1 = this->begin();
-			const_iterator p2 = right.begin();
-
-			for (; p2 != right.end(); ++p1, ++p2)
-				* p1 = *p2;
+			clear(); // keeps the map and spare blocks for the copy
+			appendDeque(right);
 		} // end outer if
 
 		return *this; // enables right = y = z, for example
 	} // end function operator=
 
+	// replace the contents by moving right's map; right is left empty
+	deque& operator=(deque&& right) noexcept
+	{
+		if (&right != this)
+		{
+			tidy();
+			takeMap(right);
+		}
+
+		return *this;
+	}
+
 	// return iterator for beginning of mutable sequence
 	iterator begin()
 	{
@@ -690,9 +724,81 @@ public:
 		return *(end() - 1);
 	}
 
+	// Segment access: the elements of a deque are stored in blocks, and each block
+	// holds a contiguous run of elements. segment returns a pointer to the element
+	// at position pos and sets len to the number of elements, at most count, that
+	// follow it contiguously in the same block (pos + count <= size()).
+	const_pointer segment(size_type pos, size_type count, size_type& len) const
+	{
+		size_type off = myData.myOff + pos;
+		size_type inBlock = off & blockMask;
+		len = blockSize - inBlock < count ? blockSize - inBlock : count;
+		return myData.map[getBlock(off)] + inBlock;
+	}
+
+	pointer segment(size_type pos, size_type count, size_type& len)
+	{
+		return const_cast<pointer>(
+			static_cast<const deque&>(*this).segment(pos, count, len));
+	}
+
+	// call func(first, last) on each contiguous run [first, last) of elements
+	// in [pos, pos + count), in order
+	template< class Func >
+	void for_each_segment(size_type pos, size_type count, Func func) const
+	{
+		while (count > 0)
+		{
+			size_type len;
+			const_pointer first = segment(pos, count, len);
+			func(first, first + len);
+			pos += len;
+			count -= len;
+		}
+	}
+
+	template< class Func >
+	void for_each_segment(size_type pos, size_type count, Func func)
+	{
+		while (count > 0)
+		{
+			size_type len;
+			pointer first = segment(pos, count, len);
+			func(first, first + len);
+			pos += len;
+			count -= len;
+		}
+	}
+
+	// call func(first, last) on each contiguous run of the whole sequence
+	template< class Func >
+	void for_each_segment(Func func) const
+	{
+		for_each_segment(0, myData.mySize, func);
+	}
+
+	template< class Func >
+	void for_each_segment(Func func)
+	{
+		for_each_segment(0, myData.mySize, func);
+	}
+
 	// insert element at beginning
 	void push_front(const Ty& val)
 	{
+		emplace_front(val);
+	}
+
+	void push_front(Ty&& val)
+	{
+		emplace_front(std::move(val));
+	}
+
+	// insert element constructed in place from args at beginning
+	template< class... Args >
+	reference emplace_front(Args&&... args)
+	{
+		size_type newFront;
 		if (myData.mySize == 0)
 		{
 			if (myData.mapSize == 0)
@@ -700,40 +806,57 @@ public:
 				myData.mapSize = 8;
 				myData.map = new Ty * [myData.mapSize]();
 			}
-			myData.myOff = 4 * myData.mapSize - 1;
+			newFront = blockSize * myData.mapSize - 1;
 		}
 		else
 		{
-			if (myData.myOff == 4 * myData.mapSize)
-				myData.myOff = 0;
-
-			int newFront = (myData.myOff - 1) % (4 * myData.mapSize);
-			if (newFront % 4 == 3 && myData.mySize >= 4 * (myData.mapSize - 1))
+			newFront = (myData.myOff - 1) & (blockSize * myData.mapSize - 1);
+			if ((newFront & blockMask) == blockMask
+				&& myData.mySize >= blockSize * (myData.mapSize - 1))
 			{
 				doubleMapSize();
-				newFront = (myData.myOff - 1) % (4 * myData.mapSize);
+				newFront = (myData.myOff - 1) & (blockSize * myData.mapSize - 1);
 			}
-			myData.myOff = newFront;
 		}
 
-		int block = getBlock(myData.myOff);
+		size_type block = getBlock(newFront);
 		if (myData.map[block] == nullptr)
-			myData.map[block] = new Ty[4]();
-		myData.map[block][myData.myOff % 4] = val;
+			myData.map[block] = buyBlock();
+		Ty* elem = myData.map[block] + (newFront & blockMask);
+		::new (static_cast<void*>(elem)) Ty(std::forward< Args >(args)...);
+		myData.myOff = newFront;
 		myData.mySize++;
+		return *elem;
 	}
 
 	// erase element at beginning
 	void pop_front()
 	{
+		size_type block = getBlock(myData.myOff);
+		myData.map[block][myData.myOff & blockMask].~Ty();
 		if (--myData.mySize == 0)
+		{
 			myData.myOff = 0;
-		else
-			++myData.myOff;
+			freeBlock(block);
+		}
+		else if ((++myData.myOff & blockMask) == 0)
+			freeBlock(block);
 	}
 
 	// insert element at end
 	void push_back(const Ty& val)
+	{
+		emplace_back(val);
+	}
+
+	void push_back(Ty&& val)
+	{
+		emplace_back(std::move(val));
+	}
+
+	// insert element constructed in place from args at end
+	template< class... Args >
+	reference emplace_back(Args&&... args)
 	{
 		if (myData.mapSize == 0)
 		{
@@ -741,58 +864,536 @@ public:
 			myData.map = new Ty * [myData.mapSize]();
 		}
 
-		int newBack = myData.myOff + myData.mySize;
-		if (newBack % 4 == 0 && myData.mySize >= 4 * (myData.mapSize - 1))
+		if (((myData.myOff + myData.mySize) & blockMask) == 0
+			&& myData.mySize >= blockSize * (myData.mapSize - 1))
 			doubleMapSize();
 
-		int block = getBlock(newBack);
+		size_type newBack = myData.myOff + myData.mySize;
+		size_type block = getBlock(newBack);
 		if (myData.map[block] == nullptr)
-			myData.map[block] = new Ty[4]();
-		myData.map[block][newBack % 4] = val;
+			myData.map[block] = buyBlock();
+		Ty* elem = myData.map[block] + (newBack & blockMask);
+		::new (static_cast<void*>(elem)) Ty(std::forward< Args >(args)...);
 		myData.mySize++;
+		return *elem;
 	}
 
 	// erase element at end
 	void pop_back()
 	{
-		if (--myData.mySize == 0)
+		size_type back = myData.myOff + --myData.mySize;
+		myData.map[getBlock(back)][back & blockMask].~Ty();
+		if (myData.mySize == 0 || (back & blockMask) == 0)
+			freeBlock(getBlock(back));
+		if (myData.mySize == 0)
 			myData.myOff = 0;
 	}
 
-	// erase all
-	void clear()
+	// insert val before pos; the elements on the side of pos nearer to an end
+	// of the sequence are shifted toward that end
+	iterator insert(const_iterator pos, const Ty& val)
 	{
-		if (myData.mapSize > 0)
-		{
-			for (size_type i = 0; i < myData.mapSize; i++)
-				if (myData.map[i] != nullptr)
-					delete[] myData.map[i];
-			delete[] myData.map;
+		Ty tmp(val); // val may be an element of this deque
+		return insert(pos, std::move(tmp));
+	}
 
-			myData.mapSize = 0;
-			myData.mySize = 0;
-			myData.myOff = 0;
-			myData.map = MapPtr();
+	iterator insert(const_iterator pos, Ty&& val)
+	{
+		Ty* first = &val;
+		return insertN(pos - cbegin(), std::make_move_iterator(first), 1);
+	}
+
+	// insert copies of [first, last) before pos
+	template< class InIt,
+		class = typename std::iterator_traits< InIt >::iterator_category >
+	iterator insert(const_iterator pos, InIt first, InIt last)
+	{
+		return insertRange(pos - cbegin(), first, last,
+			typename std::iterator_traits< InIt >::iterator_category());
+	}
+
+	// erase the element at pos; returns an iterator to the element that followed it
+	iterator erase(const_iterator pos)
+	{
+		return erase(pos, pos + 1);
+	}
+
+	// erase [first, last), shifting the shorter of the two remaining parts
+	// of the sequence over the gap; returns an iterator to the element that followed
+	iterator erase(const_iterator first, const_iterator last)
+	{
+		size_type off = first - cbegin();
+		size_type count = last - first;
+		size_type after = myData.mySize - off - count;
+
+		if (count == 0)
+			;
+		else if (off < after)
+		{	// shift the front part back over the gap, then drop the front
+			moveBackward(0, count, off);
+			for (; count > 0; count--)
+				pop_front();
+		}
+		else
+		{	// shift the back part forward over the gap, then drop the back
+			moveForward(off + count, off, after);
+			for (; count > 0; count--)
+				pop_back();
 		}
+
+		return begin() + static_cast<difference_type>(off);
+	}
+
+	// append copies of [first, last) at the end; the map grows at most once
+	// and all the needed blocks are allocated before any element is copied
+	template< class InIt,
+		class = typename std::iterator_traits< InIt >::iterator_category >
+	void append(InIt first, InIt last)
+	{
+		appendRange(first, last, typename std::iterator_traits< InIt >::iterator_category());
+	}
+
+	// insert copies of [first, last) at the beginning, in the same order
+	template< class InIt,
+		class = typename std::iterator_traits< InIt >::iterator_category >
+	void prepend(InIt first, InIt last)
+	{
+		prependRange(first, last, typename std::iterator_traits< InIt >::iterator_category());
+	}
+
+	// replace the contents with count copies of val,
+	// overwriting the existing elements before allocating new ones
+	void assign(size_type count, const Ty& val)
+	{
+		Ty tmp(val); // val may be an element of this deque
+		size_type keep = count < myData.mySize ? count : myData.mySize;
+		for_each_segment(0, keep, [&tmp](Ty* first, Ty* last)
+		{
+			std::fill(first, last, tmp);
+		});
+		resize(count, tmp);
+	}
+
+	// change the length to newSize, appending value-initialized elements if it grows
+	void resize(size_type newSize)
+	{
+		resize(newSize, Ty());
+	}
+
+	// change the length to newSize, appending copies of val if it grows
+	void resize(size_type newSize, const Ty& val)
+	{
+		if (newSize > myData.mySize)
+			appendN(newSize - myData.mySize, val);
+		else
+			while (myData.mySize > newSize)
+				pop_back();
+	}
+
+	// erase all; the map and up to spareLimit blocks are kept for reuse
+	void clear()
+	{
+		destroySegments(0, myData.mySize);
+		for (size_type i = 0; i < myData.mapSize; i++)
+			if (myData.map[i] != nullptr)
+				freeBlock(i);
+
+		myData.mySize = 0;
+		myData.myOff = 0;
+	}
+
+	// release the spare blocks, and the map as well if the deque is empty
+	void shrink_to_fit()
+	{
+		while (spareCount > 0)
+			deallocateBlock(spareBlocks[--spareCount]);
+
+		if (myData.mySize == 0)
+			tidy();
 	}
 
 private:
+	// maximum number of emptied blocks kept for reuse instead of being deleted
+	static const size_type spareLimit = 8;
 
 	// determine block from offset
 	size_type getBlock(size_type off) const
 	{
 		return myData.getBlock(off);
-		//      return ( ( myData.off / 4 ) & ( myData.mapSize - 1 ) );
 	}
 
+	// Blocks are raw storage: an element is constructed in place when it is
+	// inserted and destroyed when it is erased, so empty slots cost nothing.
+	static Ty* allocateBlock()
+	{
+		return static_cast<Ty*>(::operator new(blockSize * sizeof(Ty)));
+	}
+
+	static void deallocateBlock(Ty* block)
+	{
+		::operator delete(block);
+	}
+
+	// return a new block, reusing a spare one if possible
+	Ty* buyBlock()
+	{
+		if (spareCount > 0)
+			return spareBlocks[--spareCount];
+		return allocateBlock();
+	}
+
+	// detach the block in map slot block, keeping it as a spare if there is room;
+	// its elements must already be destroyed
+	void freeBlock(size_type block)
+	{
+		if (spareCount < spareLimit)
+			spareBlocks[spareCount++] = myData.map[block];
+		else
+			deallocateBlock(myData.map[block]);
+		myData.map[block] = nullptr;
+	}
+
+	// destroy the elements at positions [pos, pos + count), leaving their slots raw
+	void destroySegments(size_type pos, size_type count)
+	{
+		if (std::is_trivially_destructible< Ty >::value)
+			return;
+
+		for_each_segment(pos, count, [](Ty* first, Ty* last)
+		{
+			for (; first != last; ++first)
+				first->~Ty();
+		});
+	}
+
+	// take over right's map and elements, leaving right empty
+	void takeMap(deque& right)
+	{
+		myData.map = right.myData.map;
+		myData.mapSize = right.myData.mapSize;
+		myData.myOff = right.myData.myOff;
+		myData.mySize = right.myData.mySize;
+
+		right.myData.map = MapPtr();
+		right.myData.mapSize = 0;
+		right.myData.myOff = 0;
+		right.myData.mySize = 0;
+	}
+
+	// append copies of right's elements, one of its blocks at a time
+	void appendDeque(const deque& right)
+	{
+		reserveBack(right.size());
+		right.for_each_segment([this](const Ty* first, const Ty* last)
+		{
+			size_type count = static_cast<size_type>(last - first);
+			copySegments(myData.mySize, count, first);
+			myData.mySize += count;
+		});
+	}
+
+	// move count elements from position src to position dst < src, front to back,
+	// one run of elements contiguous in both source and destination at a time
+	void moveForward(size_type src, size_type dst, size_type count)
+	{
+		while (count > 0)
+		{
+			size_type srcLen, dstLen;
+			pointer pSrc = segment(src, count, srcLen);
+			pointer pDst = segment(dst, count, dstLen);
+			size_type len = srcLen < dstLen ? srcLen : dstLen;
+			std::move(pSrc, pSrc + len, pDst);
+			src += len;
+			dst += len;
+			count -= len;
+		}
+	}
+
+	// move count elements from position src to position dst > src, back to front
+	void moveBackward(size_type src, size_type dst, size_type count)
+	{
+		size_type srcEnd = src + count;
+		size_type dstEnd = dst + count;
+		while (count > 0)
+		{
+			size_type srcLen = ((myData.myOff + srcEnd - 1) & blockMask) + 1;
+			size_type dstLen = ((myData.myOff + dstEnd - 1) & blockMask) + 1;
+			size_type len = srcLen < dstLen ? srcLen : dstLen;
+			if (len > count)
+				len = count;
+
+			size_type unused;
+			pointer pSrc = segment(srcEnd - len, len, unused);
+			pointer pDst = segment(dstEnd - len, len, unused);
+			std::move_backward(pSrc, pSrc + len, pDst + len);
+			srcEnd -= len;
+			dstEnd -= len;
+			count -= len;
+		}
+	}
+
+	// insert the n elements first[0], ..., first[n - 1] before position off;
+	// new slots are opened at whichever end is nearer to off
+	template< class RanIt >
+	iterator insertN(size_type off, RanIt first, size_type n)
+	{
+		size_type after = myData.mySize - off;
+		if (n == 0)
+			;
+		else if (off <= after)
+		{	// open n slots at the front
+			if (n <= off)
+			{	// the slots take the first n elements, the rest shift toward the front
+				for (size_type i = 0; i < n; i++)
+					push_front(std::move((*this)[n - 1]));
+				moveForward(2 * n, n, off - n);
+				std::copy(first, first + n, begin() + static_cast<difference_type>(off));
+			}
+			else
+			{	// the slots take the first off elements and the head of [first, first + n)
+				for (size_type i = n - off; i > 0; i--)
+					push_front(first[i - 1]);
+				for (size_type i = 0; i < off; i++)
+					push_front(std::move((*this)[n - 1]));
+				std::copy(first + (n - off), first + n, begin() + static_cast<difference_type>(n));
+			}
+		}
+		else
+		{	// open n slots at the back
+			size_type oldSize = myData.mySize;
+			if (n <= after)
+			{	// the slots take the last n elements, the rest shift toward the back
+				for (size_type i = 0; i < n; i++)
+					push_back(std::move((*this)[oldSize - n + i]));
+				moveBackward(off, off + n, after - n);
+				std::copy(first, first + n, begin() + static_cast<difference_type>(off));
+			}
+			else
+			{	// the slots take the tail of [first, first + n) and the last after elements
+				for (size_type i = after; i < n; i++)
+					push_back(first[i]);
+				for (size_type i = 0; i < after; i++)
+					push_back(std::move((*this)[off + i]));
+				std::copy(first, first + after, begin() + static_cast<difference_type>(off));
+			}
+		}
+
+		return begin() + static_cast<difference_type>(off);
+	}
+
+	template< class InIt >
+	iterator insertRange(size_type off, InIt first, InIt last, std::input_iterator_tag)
+	{	// buffer the range, since insertN needs random access and its length
+		std::vector< Ty > buffer(first, last);
+		return insertN(off, std::make_move_iterator(buffer.begin()), buffer.size());
+	}
+
+	template< class RanIt >
+	iterator insertRange(size_type off, RanIt first, RanIt last,
+		std::random_access_iterator_tag)
+	{
+		return insertN(off, first, static_cast<size_type>(last - first));
+	}
+
+	// make room for count more elements at the back:
+	// grow the map once if needed and allocate every block the new elements will use
+	void reserveBack(size_type count)
+	{
+		reserveMap(count);
+		reserveBlocks(myData.myOff + myData.mySize, count);
+	}
+
+	// make room for count more elements at the front;
+	// returns the offset the new first element will have
+	size_type reserveFront(size_type count)
+	{
+		reserveMap(count);
+		size_type newOff = (myData.myOff - count) & (blockSize * myData.mapSize - 1);
+		reserveBlocks(newOff, count);
+		return newOff;
+	}
+
+	// grow the map in one step so that it can hold count more elements
+	void reserveMap(size_type count)
+	{
+		size_type newSize = myData.mapSize == 0 ? 8 : myData.mapSize;
+		while (myData.mySize + count > blockSize * (newSize - 1))
+			newSize *= 2;
+
+		if (myData.mapSize == 0)
+		{
+			myData.map = new Ty * [newSize]();
+			myData.mapSize = newSize;
+		}
+		else if (newSize != myData.mapSize)
+			growMap(newSize);
+	}
+
+	// allocate the missing blocks for the count offsets starting at off
+	void reserveBlocks(size_type off, size_type count)
+	{
+		if (count == 0)
+			return;
+
+		size_type lastBlock = (off + count - 1) >> blockShift;
+		for (size_type i = off >> blockShift; i <= lastBlock; i++)
+			if (myData.map[i & (myData.mapSize - 1)] == nullptr)
+				myData.map[i & (myData.mapSize - 1)] = buyBlock();
+	}
+
+	// construct copies of the count elements starting at first in the raw
+	// positions [pos, pos + count), one block at a time; if a copy throws,
+	// the elements already constructed are destroyed
+	template< class FwdIt >
+	void copySegments(size_type pos, size_type count, FwdIt first)
+	{
+		size_type done = 0;
+		try
+		{
+			for_each_segment(pos, count, [&first, &done](Ty* dest, Ty* destLast)
+			{
+				first = copyBlock(first, dest, destLast,
+					typename std::iterator_traits< FwdIt >::iterator_category());
+				done += static_cast<size_type>(destLast - dest);
+			});
+		}
+		catch (...)
+		{
+			destroySegments(pos, done);
+			throw;
+		}
+	}
+
+	// construct into [dest, destLast), returns the source position after the last
+	// element copied; constructs all or nothing
+	template< class FwdIt >
+	static FwdIt copyBlock(FwdIt first, Ty* dest, Ty* destLast, std::forward_iterator_tag)
+	{
+		Ty* next = dest;
+		try
+		{
+			for (; next != destLast; ++next, ++first)
+				::new (static_cast<void*>(next)) Ty(*first);
+		}
+		catch (...)
+		{
+			for (; dest != next; ++dest)
+				dest->~Ty();
+			throw;
+		}
+		return first;
+	}
+
+	template< class RanIt >
+	static RanIt copyBlock(RanIt first, Ty* dest, Ty* destLast, std::random_access_iterator_tag)
+	{
+		RanIt last = first + (destLast - dest);
+		std::uninitialized_copy(first, last, dest);
+		return last;
+	}
+
+	// append count copies of val, one block at a time
+	void appendN(size_type count, const Ty& val)
+	{
+		if (count == 0)
+			return;
+
+		reserveBack(count);
+		size_type done = 0;
+		try
+		{
+			for_each_segment(myData.mySize, count, [&val, &done](Ty* first, Ty* last)
+			{
+				std::uninitialized_fill(first, last, val);
+				done += static_cast<size_type>(last - first);
+			});
+		}
+		catch (...)
+		{
+			destroySegments(myData.mySize, done);
+			throw;
+		}
+		myData.mySize += count;
+	}
+
+	template< class InIt >
+	void appendRange(InIt first, InIt last, std::input_iterator_tag)
+	{	// length unknown in advance, push one element at a time
+		for (; first != last; ++first)
+			push_back(*first);
+	}
+
+	template< class FwdIt >
+	void appendRange(FwdIt first, FwdIt last, std::forward_iterator_tag)
+	{
+		size_type count = static_cast<size_type>(std::distance(first, last));
+		reserveBack(count);
+		copySegments(myData.mySize, count, first);
+		myData.mySize += count;
+	}
+
+	template< class InIt >
+	void prependRange(InIt first, InIt last, std::input_iterator_tag)
+	{	// length unknown in advance, buffer the range
+		std::vector< Ty > buffer(first, last);
+		prependRange(buffer.begin(), buffer.end(), std::forward_iterator_tag());
+	}
+
+	template< class FwdIt >
+	void prependRange(FwdIt first, FwdIt last, std::forward_iterator_tag)
+	{
+		size_type count = static_cast<size_type>(std::distance(first, last));
+		if (count == 0)
+			return;
+
+		myData.myOff = reserveFront(count);
+		try
+		{
+			copySegments(0, count, first);
+		}
+		catch (...)
+		{
+			myData.myOff += count; // back to the old front
+			throw;
+		}
+		myData.mySize += count;
+	}
+
+	// destroy all elements, release all blocks, spare blocks and the map
+	void tidy()
+	{
+		destroySegments(0, myData.mySize);
+		for (size_type i = 0; i < myData.mapSize; i++)
+			if (myData.map[i] != nullptr)
+				deallocateBlock(myData.map[i]);
+		delete[] myData.map;
+		while (spareCount > 0)
+			deallocateBlock(spareBlocks[--spareCount]);
+
+		myData.mapSize = 0;
+		myData.mySize = 0;
+		myData.myOff = 0;
+		myData.map = MapPtr();
+	}
+
+	// double the map, keeping the blocks in order starting at the block of myOff;
+	// myOff is first reduced modulo the old capacity so that every block lands
+	// at its unwrapped position in the new map
 	void doubleMapSize()
 	{
-		int newSize = myData.mapSize * 2;
+		growMap(myData.mapSize * 2);
+	}
+
+	// grow the map to newSize slots (a power of 2, at least twice mapSize)
+	// in a single reallocation, the same way as doubleMapSize
+	void growMap(size_type newSize)
+	{
 		Ty** buffer = new Ty * [newSize]();
 
-		for (int i = myData.myOff / 4, t = 0; t < myData.mapSize; i++, t++)
-			if (myData.map[i % myData.mapSize] != nullptr)
-				buffer[i] = myData.map[i % myData.mapSize];
+		myData.myOff &= blockSize * myData.mapSize - 1;
+		size_type first = myData.myOff >> blockShift;
+		for (size_type i = first, t = 0; t < myData.mapSize; i++, t++)
+			buffer[i] = myData.map[i & (myData.mapSize - 1)];
 
 		delete[] myData.map;
 		myData.map = buffer;
@@ -800,48 +1401,172 @@ private:
 	}
 
 	ScaryVal myData;
+
+	Ty* spareBlocks[spareLimit]; // emptied blocks kept for reuse
+	size_type spareCount = 0;    // number of blocks in spareBlocks
 };
 
-// test for deque equality
-template< class Ty >
-bool operator==(const deque< Ty >& left, const deque< Ty >& right)
+// Block-wise algorithms: each runs a plain pointer loop over every contiguous
+// segment of the deque instead of going through the iterator, which has to
+// look up the block for every element. They carry a deque_ prefix so that
+// argument-dependent lookup never pits them against the std:: algorithms.
+
+// walk the first count elements of left and right side by side, calling
+// func(pLeft, pRight, len) on runs that are contiguous in both deques;
+// stops early and returns false as soon as func returns false
+template< class Ty, size_t BlockSize, class Func >
+bool dequeSegmentPairs(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right,
+	size_t count, Func func)
+{
+	size_t pos = 0;
+	while (pos < count)
+	{
+		size_t leftLen, rightLen;
+		const Ty* pLeft = left.segment(pos, count - pos, leftLen);
+		const Ty* pRight = right.segment(pos, count - pos, rightLen);
+		size_t len = leftLen < rightLen ? leftLen : rightLen;
+		if (!func(pLeft, pRight, len))
+			return false;
+		pos += len;
+	}
+	return true;
+}
+
+// apply func to every element of cont, in order
+template< class Ty, size_t BlockSize, class Func >
+Func deque_for_each(deque< Ty, BlockSize >& cont, Func func)
+{
+	cont.for_each_segment([&func](Ty* first, Ty* last)
+	{
+		for (; first != last; ++first)
+			func(*first);
+	});
+	return func;
+}
+
+template< class Ty, size_t BlockSize, class Func >
+Func deque_for_each(const deque< Ty, BlockSize >& cont, Func func)
+{
+	cont.for_each_segment([&func](const Ty* first, const Ty* last)
+	{
+		for (; first != last; ++first)
+			func(*first);
+	});
+	return func;
+}
+
+// copy every element of cont to dest, returns the end of the destination range
+template< class Ty, size_t BlockSize, class OutIt >
+OutIt deque_copy(const deque< Ty, BlockSize >& cont, OutIt dest)
+{
+	cont.for_each_segment([&dest](const Ty* first, const Ty* last)
+	{
+		dest = std::copy(first, last, dest);
+	});
+	return dest;
+}
+
+// test if left and right hold equal sequences
+template< class Ty, size_t BlockSize >
+bool deque_equal(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
 {
 	return left.size() == right.size()
-		&& std::equal(left.begin(), left.end(), right.begin());
+		&& dequeSegmentPairs(left, right, left.size(),
+			[](const Ty* pLeft, const Ty* pRight, size_t len)
+			{
+				return std::equal(pLeft, pLeft + len, pRight);
+			});
+}
+
+// test if left is lexicographically less than right
+template< class Ty, size_t BlockSize >
+bool deque_lexicographical_compare(const deque< Ty, BlockSize >& left,
+	const deque< Ty, BlockSize >& right)
+{
+	size_t count = left.size() < right.size() ? left.size() : right.size();
+	int result = 0; // -1 if left < right, 1 if right < left, 0 if no difference yet
+	dequeSegmentPairs(left, right, count,
+		[&result](const Ty* pLeft, const Ty* pRight, size_t len)
+		{
+			for (size_t i = 0; i < len; i++)
+			{
+				if (pLeft[i] < pRight[i])
+					result = -1;
+				else if (pRight[i] < pLeft[i])
+					result = 1;
+				else
+					continue;
+				return false;
+			}
+			return true;
+		});
+
+	return result != 0 ? result < 0 : left.size() < right.size();
+}
+
+// return an iterator to the first element of cont equal to val, or cont.end()
+template< class Ty, size_t BlockSize >
+typename deque< Ty, BlockSize >::const_iterator deque_find(const deque< Ty, BlockSize >& cont,
+	const Ty& val)
+{
+	size_t pos = 0;
+	while (pos < cont.size())
+	{
+		size_t len;
+		const Ty* first = cont.segment(pos, cont.size() - pos, len);
+		const Ty* where = std::find(first, first + len, val);
+		if (where != first + len)
+			return cont.begin() + (pos + (where - first));
+		pos += len;
+	}
+	return cont.end();
+}
+
+template< class Ty, size_t BlockSize >
+typename deque< Ty, BlockSize >::iterator deque_find(deque< Ty, BlockSize >& cont, const Ty& val)
+{
+	return cont.begin() + (deque_find(static_cast<const deque< Ty, BlockSize >&>(cont), val)
+		- static_cast<const deque< Ty, BlockSize >&>(cont).begin());
+}
+
+// test for deque equality
+template< class Ty, size_t BlockSize >
+bool operator==(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
+{
+	return deque_equal(left, right);
 }
 
 // test for deque inequality
-template< class Ty >
-bool operator!=(const deque< Ty >& left, const deque< Ty >& right)
+template< class Ty, size_t BlockSize >
+bool operator!=(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
 {
 	return !(left == right);
 }
 
 // test if left < right for deques
-template< class Ty >
-bool operator<(const deque< Ty >& left, const deque< Ty >& right)
+template< class Ty, size_t BlockSize >
+bool operator<(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
 {
-	return std::lexicographical_compare(left.begin(), left.end(),
-		right.begin(), right.end());
+	return deque_lexicographical_compare(left, right);
 }
 
 // test if left <= right for deques
-template< class Ty >
-bool operator<=(const deque< Ty >& left, const deque< Ty >& right)
+template< class Ty, size_t BlockSize >
+bool operator<=(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
 {
 	return !(right < left);
 }
 
 // test if left > right for deques
-template< class Ty >
-bool operator>(const deque< Ty >& left, const deque< Ty >& right)
+template< class Ty, size_t BlockSize >
+bool operator>(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
 {
 	return right < left;
 }
 
 // test if left >= right for deques
-template< class Ty >
-bool operator>=(const deque< Ty >& left, const deque< Ty >& right)
+template< class Ty, size_t BlockSize >
+bool operator>=(const deque< Ty, BlockSize >& left, const deque< Ty, BlockSize >& right)
 {
 	return !(left < right);
 }
@@ -0,0 +1,424 @@
+#ifndef FLAT_UNORDERED_SET
+#define FLAT_UNORDERED_SET
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+#include "Hash.h" // fast_hash
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAT_SET_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Control byte of a flat_unordered_set slot: a full slot holds the low 7 bits
+// of its element's hash (0 to 127), the other states have the high bit set.
+enum FlatCtrl : signed char
+{
+	flatEmpty = -128,  // never used, ends a probe
+	flatDeleted = -2   // erased, a probe continues past it
+};
+
+// Returns the index of the lowest set bit of a nonzero mask.
+inline unsigned int flatLowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return index;
+#else
+	return static_cast<unsigned int>(__builtin_ctz(mask));
+#endif
+}
+
+// FlatGroup class definition
+// The 16 control bytes of one group, compared all at once: each match returns
+// a 16-bit mask with bit i set if byte i matches.
+struct FlatGroup
+{
+	static const unsigned int width = 16;
+
+#ifdef FLAT_SET_SSE2
+	explicit FlatGroup(const signed char* ctrl)
+		: bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+	{
+	}
+
+	unsigned int match(signed char h2) const
+	{
+		return static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes)));
+	}
+
+	// empty and deleted are the bytes with the high bit set
+	unsigned int matchEmptyOrDeleted() const
+	{
+		return static_cast<unsigned int>(_mm_movemask_epi8(bytes));
+	}
+
+	__m128i bytes;
+#else
+	explicit FlatGroup(const signed char* ctrl)
+		: bytes(ctrl)
+	{
+	}
+
+	unsigned int match(signed char h2) const
+	{
+		unsigned int mask = 0;
+		for (unsigned int i = 0; i < width; i++)
+			if (bytes[i] == h2)
+				mask |= 1u << i;
+		return mask;
+	}
+
+	unsigned int matchEmptyOrDeleted() const
+	{
+		unsigned int mask = 0;
+		for (unsigned int i = 0; i < width; i++)
+			if (bytes[i] < 0)
+				mask |= 1u << i;
+		return mask;
+	}
+
+	const signed char* bytes;
+#endif
+
+	unsigned int matchEmpty() const
+	{
+		return match(flatEmpty);
+	}
+}; // end struct FlatGroup
+
+
+// flat_unordered_set class template definition
+// Open-addressing hash set in the Swiss-table style: the elements live inline in a
+// flat array of slots, with one control byte per slot in a separate array.
+// The slots are split into groups of 16; a key's hash picks the first group
+// (high bits) and a 7-bit tag (low bits), and a lookup compares the tag against all
+// 16 control bytes of a group in one SSE2 instruction, touching an element only on
+// a tag match. Groups are probed quadratically until one with an empty slot.
+// The table holds at most 7/8 of its slots, counting erased ones.
+// Same interface as unordered_set; find returns a pointer to the element, or end().
+// The tag and the group both come from the hash, so Hash must mix well in
+// its high and low bits; fast_hash does.
+template< typename T, typename Hash = fast_hash< T >, typename KeyEqual = std::equal_to< T > >
+class flat_unordered_set
+{
+public:
+	using iterator = const T*;
+
+	explicit flat_unordered_set(const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual());
+
+	flat_unordered_set(const flat_unordered_set& right);
+
+	flat_unordered_set(flat_unordered_set&& right) noexcept;
+
+	~flat_unordered_set();
+
+	flat_unordered_set& operator=(flat_unordered_set right);
+
+	// Returns the number of elements in the flat_unordered_set container.
+	unsigned int size() const;
+
+	// Searches the container for an element with k as value and
+	// returns a pointer to it if found, otherwise it returns end()
+	iterator find(const T& k) const;
+
+	// Returns the pointer find returns for a missing element.
+	iterator end() const;
+
+	// Inserts a new element in the flat_unordered_set.
+	// The element is inserted only if it is not equivalent to any other element
+	// already in the container.
+	void insert(const T& val);
+
+	// Removes from the flat_unordered_set container a single element.
+	void erase(const T& k);
+
+	// Returns the number of slots, which play the role of buckets.
+	unsigned int bucket_count() const;
+
+	// Removes all elements, keeping the slots.
+	void clear();
+
+	void swap(flat_unordered_set& right) noexcept;
+
+private:
+	signed char* ctrl; // capacity control bytes
+	T* slots;          // capacity slots, constructed where ctrl is full
+	size_t capacity;   // number of slots, 0 or a power of 2 >= FlatGroup::width
+	size_t mySize;     // number of elements
+	size_t growthLeft; // insertions into empty slots left before a rehash
+
+	Hash myHash;      // hash function object
+	KeyEqual myEqual; // key equality function object
+
+	// Returns the hash of k: high bits pick the group, low 7 bits are the tag.
+	size_t hashOf(const T& k) const;
+
+	// Returns the slot holding k, or capacity if there is none.
+	size_t findSlot(const T& k, size_t hash) const;
+
+	// Returns the first empty or deleted slot on the probe sequence of hash.
+	size_t findFreeSlot(size_t hash) const;
+
+	// Moves all elements into a table of newCapacity slots.
+	void rehash(size_t newCapacity);
+
+	// Destroys all elements and releases the arrays.
+	void tidy();
+}; // end class template flat_unordered_set
+
+
+template< typename T, typename Hash, typename KeyEqual >
+flat_unordered_set< T, Hash, KeyEqual >::flat_unordered_set(const Hash& hash, const KeyEqual& equal)
+	: ctrl(nullptr),
+	slots(nullptr),
+	capacity(0),
+	mySize(0),
+	growthLeft(0),
+	myHash(hash),
+	myEqual(equal)
+{
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+flat_unordered_set< T, Hash, KeyEqual >::flat_unordered_set(const flat_unordered_set& right)
+	: flat_unordered_set(right.myHash, right.myEqual)
+{
+	if (right.mySize == 0)
+		return;
+
+	rehash(right.capacity);
+	try
+	{
+		for (size_t i = 0; i < right.capacity; i++)
+			if (right.ctrl[i] >= 0)
+				insert(right.slots[i]);
+	}
+	catch (...)
+	{
+		tidy();
+		throw;
+	}
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+flat_unordered_set< T, Hash, KeyEqual >::flat_unordered_set(flat_unordered_set&& right) noexcept
+	: flat_unordered_set(right.myHash, right.myEqual)
+{
+	swap(right);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+flat_unordered_set< T, Hash, KeyEqual >::~flat_unordered_set()
+{
+	tidy();
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+flat_unordered_set< T, Hash, KeyEqual >& flat_unordered_set< T, Hash, KeyEqual >::operator=(flat_unordered_set right)
+{
+	swap(right);
+	return *this;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int flat_unordered_set< T, Hash, KeyEqual >::size() const
+{
+	return static_cast<unsigned int>(mySize);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename flat_unordered_set< T, Hash, KeyEqual >::iterator flat_unordered_set< T, Hash, KeyEqual >::find(const T& k) const
+{
+	size_t i = findSlot(k, hashOf(k));
+	return i == capacity ? end() : slots + i;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename flat_unordered_set< T, Hash, KeyEqual >::iterator flat_unordered_set< T, Hash, KeyEqual >::end() const
+{
+	return nullptr;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void flat_unordered_set< T, Hash, KeyEqual >::insert(const T& val)
+{
+	size_t hash = hashOf(val);
+	if (findSlot(val, hash) != capacity)
+		return;
+
+	if (growthLeft == 0)
+	{	// grow, unless erased slots make up most of the load
+		size_t newCapacity = capacity == 0 ? FlatGroup::width : capacity;
+		if (mySize >= newCapacity / 2 - newCapacity / 16)
+			newCapacity *= 2;
+		rehash(newCapacity);
+	}
+
+	size_t i = findFreeSlot(hash);
+	::new (static_cast<void*>(slots + i)) T(val);
+	if (ctrl[i] == flatEmpty)
+		growthLeft--;
+	ctrl[i] = static_cast<signed char>(hash & 0x7F);
+	mySize++;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void flat_unordered_set< T, Hash, KeyEqual >::erase(const T& k)
+{
+	size_t i = findSlot(k, hashOf(k));
+	if (i == capacity)
+		return;
+
+	slots[i].~T();
+	mySize--;
+
+	// a group with an empty slot already stops every probe that reaches it,
+	// so the slot can go back to empty; otherwise leave a tombstone
+	size_t group = i & ~static_cast<size_t>(FlatGroup::width - 1);
+	if (FlatGroup(ctrl + group).matchEmpty() != 0)
+	{
+		ctrl[i] = flatEmpty;
+		growthLeft++;
+	}
+	else
+		ctrl[i] = flatDeleted;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int flat_unordered_set< T, Hash, KeyEqual >::bucket_count() const
+{
+	return static_cast<unsigned int>(capacity);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void flat_unordered_set< T, Hash, KeyEqual >::clear()
+{
+	for (size_t i = 0; i < capacity; i++)
+		if (ctrl[i] >= 0)
+		{
+			slots[i].~T();
+			ctrl[i] = flatEmpty;
+		}
+		else if (ctrl[i] == flatDeleted)
+			ctrl[i] = flatEmpty;
+
+	mySize = 0;
+	growthLeft = capacity - capacity / 8;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void flat_unordered_set< T, Hash, KeyEqual >::swap(flat_unordered_set& right) noexcept
+{
+	std::swap(ctrl, right.ctrl);
+	std::swap(slots, right.slots);
+	std::swap(capacity, right.capacity);
+	std::swap(mySize, right.mySize);
+	std::swap(growthLeft, right.growthLeft);
+	std::swap(myHash, right.myHash);
+	std::swap(myEqual, right.myEqual);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+size_t flat_unordered_set< T, Hash, KeyEqual >::hashOf(const T& k) const
+{
+	return myHash(k);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+size_t flat_unordered_set< T, Hash, KeyEqual >::findSlot(const T& k, size_t hash) const
+{
+	if (capacity == 0)
+		return capacity;
+
+	size_t groupMask = capacity / FlatGroup::width - 1;
+	size_t group = (hash >> 7) & groupMask;
+	signed char h2 = static_cast<signed char>(hash & 0x7F);
+	for (size_t step = 1;; step++)
+	{
+		size_t base = group * FlatGroup::width;
+		FlatGroup g(ctrl + base);
+		for (unsigned int mask = g.match(h2); mask != 0; mask &= mask - 1)
+		{
+			size_t i = base + flatLowestBit(mask);
+			if (myEqual(slots[i], k))
+				return i;
+		}
+		if (g.matchEmpty() != 0)
+			return capacity;
+		group = (group + step) & groupMask; // triangular steps visit every group
+	}
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+size_t flat_unordered_set< T, Hash, KeyEqual >::findFreeSlot(size_t hash) const
+{
+	size_t groupMask = capacity / FlatGroup::width - 1;
+	size_t group = (hash >> 7) & groupMask;
+	for (size_t step = 1;; step++)
+	{
+		size_t base = group * FlatGroup::width;
+		unsigned int mask = FlatGroup(ctrl + base).matchEmptyOrDeleted();
+		if (mask != 0)
+			return base + flatLowestBit(mask);
+		group = (group + step) & groupMask;
+	}
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void flat_unordered_set< T, Hash, KeyEqual >::rehash(size_t newCapacity)
+{
+	flat_unordered_set table(myHash, myEqual);
+	table.ctrl = static_cast<signed char*>(::operator new(newCapacity));
+	try
+	{
+		table.slots = static_cast<T*>(::operator new(newCapacity * sizeof(T)));
+	}
+	catch (...)
+	{
+		::operator delete(table.ctrl);
+		table.ctrl = nullptr;
+		throw;
+	}
+	table.capacity = newCapacity;
+	table.growthLeft = newCapacity - newCapacity / 8;
+	for (size_t i = 0; i < newCapacity; i++)
+		table.ctrl[i] = flatEmpty;
+
+	// elements are distinct, so each goes straight to a free slot
+	for (size_t i = 0; i < capacity; i++)
+		if (ctrl[i] >= 0)
+		{
+			size_t hash = hashOf(slots[i]);
+			size_t j = table.findFreeSlot(hash);
+			::new (static_cast<void*>(table.slots + j)) T(std::move(slots[i]));
+			table.ctrl[j] = static_cast<signed char>(hash & 0x7F);
+			table.growthLeft--;
+			table.mySize++;
+		}
+
+	swap(table);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void flat_unordered_set< T, Hash, KeyEqual >::tidy()
+{
+	for (size_t i = 0; i < capacity; i++)
+		if (ctrl[i] >= 0)
+			slots[i].~T();
+	::operator delete(ctrl);
+	::operator delete(slots);
+
+	ctrl = nullptr;
+	slots = nullptr;
+	capacity = mySize = growthLeft = 0;
+}
+
+#endif
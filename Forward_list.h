@@ -1,24 +1,59 @@
-#ifndef LIST_H
-#define LIST_H
+#ifndef FORWARD_LIST_H
+#define FORWARD_LIST_H
 
 #include <forward_list> // include definition of class template forward_list
+#include <functional>   // std::less, std::equal_to
+#include <utility>      // std::forward, std::move
+
+template< typename T >
+struct FlistNode;
+
+// FlistLink class template definition
+// The link part of a node; a forward_list keeps one as its before-begin node.
+template< typename T >
+struct FlistLink
+{
+	FlistNode< T > *next;
+}; // end class template FlistLink
 
 // FlistNode class template definition
 template< typename T >
-struct FlistNode
+struct FlistNode : FlistLink< T >
 {
-	FlistNode *next;
+	// constructs myVal in place from args
+	template< typename... Args >
+	FlistNode(FlistNode *nextNode, Args&&... args)
+		: FlistLink< T >{ nextNode },
+		myVal(std::forward< Args >(args)...)
+	{
+	}
+
 	T myVal;
 }; // end class template FlistNode
 
+// FlistTail class template definition
+// The last node and number of elements of a forward_list that tracks them;
+// empty for one that does not.
+template< typename T, bool TrackTail >
+struct FlistTail
+{
+	FlistNode< T > *myTail = nullptr; // last node, nullptr if empty
+	unsigned int mySize = 0;          // number of elements
+}; // end class template FlistTail
+
+template< typename T >
+struct FlistTail< T, false >
+{
+}; // end class template FlistTail
+
 
 // ListIterator class template definition
 template< typename T >
 class ListIterator
 {
-	template< typename T > friend class forward_list;
+	template< typename U, bool TrackTail > friend class forward_list;
 public:
-	ListIterator(FlistNode< T > *p = nullptr) // default constructor
+	ListIterator(FlistLink< T > *p = nullptr) // default constructor
 		: ptr(p)
 	{
 	}
@@ -52,7 +87,7 @@ public:
 
 	T& operator*() const // dereferencing operator
 	{
-		return ptr->myVal;
+		return static_cast< FlistNode< T > * >(ptr)->myVal;
 	}
 
 	ListIterator& operator++() // prefix increment operator
@@ -62,22 +97,24 @@ public:
 	}
 
 private:
-	FlistNode< T > *ptr; // keep a pointer to forward_list
+	FlistLink< T > *ptr; // keep a pointer to forward_list
 }; // end class template ListIterator
 
 
 // forward_list class template definition
-template< typename T >
-class forward_list
+// If TrackTail is true, the container also keeps a pointer to its last node
+// and its number of elements, so that push_back and size take constant time.
+template< typename T, bool TrackTail = false >
+class forward_list : private FlistTail< T, TrackTail >
 {
-	template< typename T >
-	friend bool operator==(std::forward_list< T > &stdList, forward_list< T > &myList);
+	template< typename U, bool Track >
+	friend bool operator==(std::forward_list< U > &stdList, forward_list< U, Track > &myList);
 
-	template< typename T >
-	friend bool operator==(const forward_list< T > &lhs, const forward_list< T > &rhs);
+	template< typename U, bool Track >
+	friend bool operator==(const forward_list< U, Track > &lhs, const forward_list< U, Track > &rhs);
 
-	template< typename T >
-	friend bool operator!=(const forward_list< T > &lhs, const forward_list< T > &rhs);
+	template< typename U, bool Track >
+	friend bool operator!=(const forward_list< U, Track > &lhs, const forward_list< U, Track > &rhs);
 
 public:
 	using iterator = ListIterator< T >;
@@ -96,6 +133,10 @@ public:
 	// Assigns new contents to the container, replacing its current contents,
 	const forward_list& operator=(const forward_list &x);
 
+	// Returns an iterator pointing to the position before the first element
+	// in the forward_list container; it shall not be dereferenced.
+	iterator before_begin() const;
+
 	// Returns an iterator pointing to the first element in the forward_list container.
 	iterator begin() const;
 
@@ -105,12 +146,63 @@ public:
 	// Returns a bool value indicating whether the forward_list container is empty
 	bool empty() const;
 
+	// Returns the number of elements in the forward_list container.
+	// Constant time if TrackTail is true, linear otherwise.
+	unsigned int size() const;
+
 	T& front(); // Returns a reference to the first element in the forward_list container
 
+	// Returns a reference to the last element in the forward_list container.
+	// Constant time if TrackTail is true, linear otherwise.
+	T& back();
+
 	// Inserts a new element at the beginning of the forward_list,
 	// right before its current first element.
 	// The content of val is copied (or moved) to the inserted element.
-	void push_front(const T val);
+	void push_front(const T &val);
+	void push_front(T &&val);
+
+	// Inserts a new element constructed in place from args
+	// at the beginning of the forward_list.
+	template< typename... Args >
+	T& emplace_front(Args&&... args);
+
+	// Inserts a new element at the end of the forward_list.
+	// Constant time if TrackTail is true, linear otherwise.
+	void push_back(const T &val);
+	void push_back(T &&val);
+
+	// Inserts a new element constructed in place from args
+	// at the end of the forward_list.
+	// Constant time if TrackTail is true, linear otherwise.
+	template< typename... Args >
+	T& emplace_back(Args&&... args);
+
+	// Inserts a new element constructed in place from args
+	// right after the element at position.
+	// Returns an iterator pointing to the inserted element.
+	template< typename... Args >
+	iterator emplace_after(iterator position, Args&&... args);
+
+	// Inserts a copy of (or moves) val right after the element at position.
+	// Returns an iterator pointing to the inserted element.
+	iterator insert_after(iterator position, const T &val);
+	iterator insert_after(iterator position, T &&val);
+
+	// Inserts copies of the elements in the range [first, last)
+	// right after the element at position, in the same order.
+	// Returns an iterator pointing to the last inserted element,
+	// or position if the range is empty.
+	template< typename InputIt >
+	iterator insert_after(iterator position, InputIt first, InputIt last);
+
+	// Removes the element right after position.
+	// Returns an iterator pointing to the element following the erased one.
+	iterator erase_after(iterator position);
+
+	// Removes the elements in the range (first, last).
+	// Returns last.
+	iterator erase_after(iterator first, iterator last);
 
 	// Removes the first element in the forward_list container
 	void pop_front();
@@ -129,163 +221,380 @@ public:
 	// Reverses the order of the elements in the forward_list container.
 	void reverse();
 
+	// Transfers all the elements of x into the container, right after position.
+	// x is left empty. No elements are copied or moved, only relinked.
+	void splice_after(iterator position, forward_list &x);
+
+	// Transfers the element right after i in x into the container, right after position.
+	void splice_after(iterator position, forward_list &x, iterator i);
+
+	// Transfers the elements in the range (first, last) of x into the container,
+	// right after position.
+	void splice_after(iterator position, forward_list &x, iterator first, iterator last);
+
+	// Removes all the elements that are equal to val / for which pred returns true.
+	// Returns the number of elements removed.
+	unsigned int remove(const T &val);
+	template< typename Predicate >
+	unsigned int remove_if(Predicate pred);
+
+	// Removes all but the first element from every group of consecutive
+	// equal elements (as determined by operator== or pred).
+	// Returns the number of elements removed.
+	unsigned int unique();
+	template< typename BinaryPredicate >
+	unsigned int unique(BinaryPredicate pred);
+
+	// Merges the sorted list x into the sorted container by relinking nodes;
+	// equivalent elements from the container precede those from x. x is left empty.
+	void merge(forward_list &x);
+	template< typename Compare >
+	void merge(forward_list &x, Compare comp);
+
+	// Sorts the elements in the container, in ascending order (stable).
+	// Natural merge sort: already-ordered runs are found and merged pairwise
+	// by relinking nodes, so values are never copied or moved.
+	void sort();
+	template< typename Compare >
+	void sort(Compare comp);
+
 private:
-	// pointing to the past-the-end element in the forward_list container
-	FlistNode< T > *myHead;
+	// before-begin node; its next points to the first element in the forward_list container
+	FlistLink< T > myHead;
+
+	// Returns the last node of the forward_list container, or the before-begin node if empty.
+	FlistLink< T > *lastNode() const;
+
+	// Records that count nodes, ending with last, were linked into the container.
+	void linked(FlistNode< T > *last, unsigned int count);
+
+	// Records that count nodes were unlinked right after prev.
+	void unlinked(FlistLink< T > *prev, unsigned int count);
+
+	// Detaches the ascending run starting at first; sets last to its last node
+	// and rest to the node following it.
+	template< typename Compare >
+	static FlistNode< T > *takeRun(FlistNode< T > *first, FlistNode< T > *&last,
+		FlistNode< T > *&rest, Compare comp);
+
+	// Merges the sorted chains [first1, last1] and [first2, last2] (first2 may be nullptr).
+	// Returns the head of the merged chain and sets last to its last node.
+	template< typename Compare >
+	static FlistNode< T > *mergeChains(FlistNode< T > *first1, FlistNode< T > *last1,
+		FlistNode< T > *first2, FlistNode< T > *last2, FlistNode< T > *&last, Compare comp);
+
+	// Empties x after its nodes were moved into the container.
+	static void release(forward_list &x);
 }; // end class template forward_list
 
 
 // Constructs a container with n elements.
-template< typename T >
-forward_list< T >::forward_list(unsigned int n)
-	: myHead(nullptr)
+template< typename T, bool TrackTail >
+forward_list< T, TrackTail >::forward_list(unsigned int n)
+	: myHead{ nullptr }
 {
-	if (n > 0)
-	{
-		FlistNode< T > *newNode;
-		for (unsigned int i = 0; i < n; i++)
-		{
-			newNode = new FlistNode< T >;
-			newNode->myVal = T();
-			newNode->next = myHead;
-			myHead = newNode;
-		}
-	}
+	for (unsigned int i = 0; i < n; i++)
+		emplace_front();
 }
 
 // Constructs a forward_list container with a copy of each of the elements in x,
 // in the same order.
-template< typename T >
-forward_list< T >::forward_list(const forward_list< T > &x)
-	: myHead(nullptr)
+template< typename T, bool TrackTail >
+forward_list< T, TrackTail >::forward_list(const forward_list &x)
+	: myHead{ nullptr }
 {
-	iterator right = x.begin();
-	for (; right != x.end(); ++right)
-		push_front(*right);
-
-	reverse();
+	insert_after(before_begin(), x.begin(), x.end());
 }
 
 // Destroys all forward_list container elements,
 // and deallocates all the storage allocated by the forward_list container.
-template< typename T >
-forward_list< T >::~forward_list()
+template< typename T, bool TrackTail >
+forward_list< T, TrackTail >::~forward_list()
 {
 	clear();
-	delete myHead;
 }
 
 // Assigns new contents to the container, replacing its current contents,
-template< typename T >
-const forward_list< T >& forward_list< T >::operator=(const forward_list< T > &x)
+template< typename T, bool TrackTail >
+const forward_list< T, TrackTail >& forward_list< T, TrackTail >::operator=(const forward_list &x)
 {
 	if (&x != this) // avoid self-assignment
 	{
 		clear();
-
-		iterator right = x.begin();
-		for (; right != x.end(); ++right)
-			push_front(*right);
-
-		reverse();
+		insert_after(before_begin(), x.begin(), x.end());
 	}
 
 	return *this; // enables x = y = z, for example
 } // end function operator=
 
+// Returns an iterator pointing to the position before the first element,
+// which is the before-begin node myHead.
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator forward_list< T, TrackTail >::before_begin() const
+{
+	return iterator(const_cast< FlistLink< T > * >(&myHead));
+}
+
 // Returns an iterator pointing to the first element in the forward_list container.
-template< typename T >
-typename forward_list< T >::iterator forward_list< T >::begin() const
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator forward_list< T, TrackTail >::begin() const
 {
-	return iterator(myHead);
+	return iterator(myHead.next);
 }
 
 // Returns an iterator referring to the past-the-end element in the forward_list container.
-template< typename T >
-typename forward_list< T >::iterator forward_list< T >::end() const
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator forward_list< T, TrackTail >::end() const
 {
 	return iterator(nullptr);
 }
 
 // Returns a bool value indicating whether the forward_list container is empty
-template< typename T >
-bool forward_list< T >::empty() const
+template< typename T, bool TrackTail >
+bool forward_list< T, TrackTail >::empty() const
 {
-	return (myHead == nullptr);
+	return (myHead.next == nullptr);
+}
+
+// Returns the number of elements in the forward_list container.
+template< typename T, bool TrackTail >
+unsigned int forward_list< T, TrackTail >::size() const
+{
+	if constexpr (TrackTail)
+		return this->mySize;
+
+	unsigned int count = 0;
+	for (FlistNode< T > *p = myHead.next; p != nullptr; p = p->next)
+		count++;
+	return count;
 }
 
 // Returns a reference to the first element in the forward_list container
-template< typename T >
-T& forward_list< T >::front()
+template< typename T, bool TrackTail >
+T& forward_list< T, TrackTail >::front()
+{
+	return myHead.next->myVal;
+}
+
+// Returns a reference to the last element in the forward_list container.
+template< typename T, bool TrackTail >
+T& forward_list< T, TrackTail >::back()
 {
-	return myHead->myVal;
+	return static_cast< FlistNode< T > * >(lastNode())->myVal;
 }
 
 // Inserts a new element at the beginning of the forward_list,
 // right before its current first element.
 // The content of val is copied (or moved) to the inserted element.
-template< typename T >
-void forward_list< T >::push_front(const T val)
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::push_front(const T &val)
 {
-	FlistNode< T > *newNode = new FlistNode< T >;
-	newNode->myVal = val;
+	emplace_front(val);
+}
 
-	newNode->next = myHead;
-	myHead = newNode;
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::push_front(T &&val)
+{
+	emplace_front(std::move(val));
 }
 
-// Removes the first element in the forward_list container
-template< typename T >
-void forward_list< T >::pop_front()
+// Inserts a new element constructed in place from args
+// at the beginning of the forward_list.
+template< typename T, bool TrackTail >
+template< typename... Args >
+T& forward_list< T, TrackTail >::emplace_front(Args&&... args)
 {
-	FlistNode< T > *temp = myHead;
-	myHead = myHead->next;
-	delete temp;
+	myHead.next = new FlistNode< T >(myHead.next, std::forward< Args >(args)...);
+	linked(myHead.next, 1);
+	return myHead.next->myVal;
 }
 
-// Resizes the forward_list container to contain n elements.
-template< typename T >
-void forward_list< T >::resize(unsigned int n)
+// Inserts a new element at the end of the forward_list.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::push_back(const T &val)
+{
+	emplace_back(val);
+}
+
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::push_back(T &&val)
+{
+	emplace_back(std::move(val));
+}
+
+// Inserts a new element constructed in place from args
+// at the end of the forward_list.
+template< typename T, bool TrackTail >
+template< typename... Args >
+T& forward_list< T, TrackTail >::emplace_back(Args&&... args)
+{
+	return *emplace_after(iterator(lastNode()), std::forward< Args >(args)...);
+}
+
+// Inserts a new element constructed in place from args
+// right after the element at position.
+template< typename T, bool TrackTail >
+template< typename... Args >
+typename forward_list< T, TrackTail >::iterator
+	forward_list< T, TrackTail >::emplace_after(iterator position, Args&&... args)
+{
+	FlistLink< T > *prev = position.ptr;
+	prev->next = new FlistNode< T >(prev->next, std::forward< Args >(args)...);
+	linked(prev->next, 1);
+	return iterator(prev->next);
+}
+
+// Inserts a copy of (or moves) val right after the element at position.
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator
+	forward_list< T, TrackTail >::insert_after(iterator position, const T &val)
 {
-	reverse();
+	return emplace_after(position, val);
+}
+
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator
+	forward_list< T, TrackTail >::insert_after(iterator position, T &&val)
+{
+	return emplace_after(position, std::move(val));
+}
 
-	int size = 0;
-	iterator p1 = begin();
-	for (; p1 != end(); ++p1)
-		size++;
+// Inserts copies of the elements in the range [first, last)
+// right after the element at position, in the same order.
+// The new nodes are built as a separate chain which is linked in at the end,
+// so the container is left unchanged if copying an element throws.
+template< typename T, bool TrackTail >
+template< typename InputIt >
+typename forward_list< T, TrackTail >::iterator
+	forward_list< T, TrackTail >::insert_after(iterator position, InputIt first, InputIt last)
+{
+	if (first == last)
+		return position;
+
+	FlistNode< T > *chainHead = new FlistNode< T >(nullptr, *first);
+	FlistNode< T > *chainTail = chainHead;
+	unsigned int count = 1;
+	try
+	{
+		for (++first; first != last; ++first, count++)
+		{
+			chainTail->next = new FlistNode< T >(nullptr, *first);
+			chainTail = chainTail->next;
+		}
+	}
+	catch (...)
+	{
+		while (chainHead != nullptr)
+		{
+			FlistNode< T > *temp = chainHead;
+			chainHead = chainHead->next;
+			delete temp;
+		}
+		throw;
+	}
 
-	if (size > n)
-		for (int i = 0; i < size - n; i++)
-			pop_front();
-	else if (n > size)
-		for (int i = 0; i < n - size; i++)
-			push_front(T());
+	FlistLink< T > *prev = position.ptr;
+	chainTail->next = prev->next;
+	prev->next = chainHead;
+	linked(chainTail, count);
 
-	reverse();
+	return iterator(chainTail);
+}
+
+// Removes the element right after position.
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator
+	forward_list< T, TrackTail >::erase_after(iterator position)
+{
+	return erase_after(position, iterator(position.ptr->next->next));
+}
+
+// Removes the elements in the range (first, last).
+template< typename T, bool TrackTail >
+typename forward_list< T, TrackTail >::iterator
+	forward_list< T, TrackTail >::erase_after(iterator first, iterator last)
+{
+	FlistLink< T > *prev = first.ptr;
+	FlistNode< T > *p = prev->next;
+	unsigned int count = 0;
+	while (p != last.ptr)
+	{
+		FlistNode< T > *temp = p;
+		p = p->next;
+		delete temp;
+		count++;
+	}
+
+	prev->next = static_cast< FlistNode< T > * >(last.ptr);
+	unlinked(prev, count);
+
+	return last;
+}
+
+// Removes the first element in the forward_list container
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::pop_front()
+{
+	FlistNode< T > *temp = myHead.next;
+	myHead.next = temp->next;
+	delete temp;
+	unlinked(&myHead, 1);
+}
+
+// Resizes the forward_list container to contain n elements.
+// Only the first min(n, size()) nodes are visited; if the size is tracked,
+// growing skips straight to the tail.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::resize(unsigned int n)
+{
+	FlistLink< T > *prev = &myHead;
+	unsigned int count = 0;
+	if constexpr (TrackTail)
+		if (n >= this->mySize)
+		{
+			prev = lastNode();
+			count = this->mySize;
+		}
+	for (; count < n && prev->next != nullptr; count++)
+		prev = prev->next;
+
+	if (count == n)
+		erase_after(iterator(prev), end());
+	else
+		for (; count < n; count++)
+			prev = emplace_after(iterator(prev)).ptr;
 }
 
 // Removes all elements from the forward_list container (which are destroyed)
-template< typename T >
-void forward_list< T >::clear()
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::clear()
 {
 	FlistNode< T > *temp;
-	while (myHead != nullptr) // the forward_list is not empty
+	while (myHead.next != nullptr) // the forward_list is not empty
 	{
-		temp = myHead;
-		myHead = myHead->next;
+		temp = myHead.next;
+		myHead.next = temp->next;
 		delete temp;
+	}
 
+	if constexpr (TrackTail)
+	{
+		this->myTail = nullptr;
+		this->mySize = 0;
 	}
 }
 
 // Reverses the order of the elements in the forward_list container.
-template< typename T >
-void forward_list< T >::reverse()
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::reverse()
 {
-	if (myHead != nullptr)
+	if (myHead.next != nullptr)
 	{
-		FlistNode< T > *current = myHead;
-		FlistNode< T > *b = myHead->next;
+		if constexpr (TrackTail)
+			this->myTail = myHead.next;
+
+		FlistNode< T > *current = myHead.next;
+		FlistNode< T > *b = current->next;
 		FlistNode< T > *a = b;
 
 		current->next = nullptr;
@@ -298,16 +607,335 @@ void forward_list< T >::reverse()
 			a = b;
 		}
 
-		myHead = current;
+		myHead.next = current;
+	}
+}
+
+// Transfers all the elements of x into the container, right after position.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::splice_after(iterator position, forward_list &x)
+{
+	if (x.myHead.next != nullptr)
+	{
+		FlistNode< T > *last = static_cast< FlistNode< T > * >(x.lastNode());
+		unsigned int count = 0;
+		if constexpr (TrackTail)
+			count = x.mySize;
+
+		last->next = position.ptr->next;
+		position.ptr->next = x.myHead.next;
+
+		release(x);
+		linked(last, count);
+	}
+}
+
+// Transfers the element right after i in x into the container, right after position.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::splice_after(iterator position, forward_list &x, iterator i)
+{
+	FlistNode< T > *node = i.ptr->next;
+	if (position.ptr != i.ptr && position.ptr != node)
+	{
+		i.ptr->next = node->next;
+		x.unlinked(i.ptr, 1);
+
+		node->next = position.ptr->next;
+		position.ptr->next = node;
+		linked(node, 1);
+	}
+}
+
+// Transfers the elements in the range (first, last) of x into the container,
+// right after position.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::splice_after(iterator position, forward_list &x,
+	iterator first, iterator last)
+{
+	if (first.ptr->next != last.ptr)
+	{
+		FlistNode< T > *begin = first.ptr->next;
+		FlistNode< T > *end = begin;
+		unsigned int count = 1;
+		for (; end->next != last.ptr; end = end->next)
+			count++;
+
+		first.ptr->next = static_cast< FlistNode< T > * >(last.ptr);
+		x.unlinked(first.ptr, count);
+
+		end->next = position.ptr->next;
+		position.ptr->next = begin;
+		linked(end, count);
+	}
+}
+
+// Removes all the elements that are equal to val.
+template< typename T, bool TrackTail >
+unsigned int forward_list< T, TrackTail >::remove(const T &val)
+{
+	// val may refer to an element of the container; remove_if only destroys
+	// the removed nodes once the whole list has been scanned
+	return remove_if([&val](const T &elem) { return elem == val; });
+}
+
+// Removes all the elements for which pred returns true.
+template< typename T, bool TrackTail >
+template< typename Predicate >
+unsigned int forward_list< T, TrackTail >::remove_if(Predicate pred)
+{
+	FlistNode< T > *removed = nullptr; // chain of unlinked nodes, destroyed at the end
+	FlistLink< T > *prev = &myHead;
+	unsigned int count = 0;
+	while (prev->next != nullptr)
+	{
+		FlistNode< T > *node = prev->next;
+		if (pred(node->myVal))
+		{
+			prev->next = node->next;
+			node->next = removed;
+			removed = node;
+			count++;
+		}
+		else
+			prev = node;
+	}
+	unlinked(prev, count);
+
+	while (removed != nullptr)
+	{
+		FlistNode< T > *temp = removed;
+		removed = removed->next;
+		delete temp;
+	}
+
+	return count;
+}
+
+// Removes all but the first element from every group of consecutive equal elements.
+template< typename T, bool TrackTail >
+unsigned int forward_list< T, TrackTail >::unique()
+{
+	return unique(std::equal_to< T >());
+}
+
+template< typename T, bool TrackTail >
+template< typename BinaryPredicate >
+unsigned int forward_list< T, TrackTail >::unique(BinaryPredicate pred)
+{
+	if (myHead.next == nullptr)
+		return 0;
+
+	FlistNode< T > *prev = myHead.next;
+	unsigned int count = 0;
+	while (prev->next != nullptr)
+	{
+		FlistNode< T > *node = prev->next;
+		if (pred(prev->myVal, node->myVal))
+		{
+			prev->next = node->next;
+			delete node;
+			count++;
+		}
+		else
+			prev = node;
+	}
+	unlinked(prev, count);
+
+	return count;
+}
+
+// Merges the sorted list x into the sorted container by relinking nodes.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::merge(forward_list &x)
+{
+	merge(x, std::less< T >());
+}
+
+template< typename T, bool TrackTail >
+template< typename Compare >
+void forward_list< T, TrackTail >::merge(forward_list &x, Compare comp)
+{
+	if (&x == this || x.myHead.next == nullptr)
+		return;
+
+	if (myHead.next == nullptr)
+	{
+		splice_after(before_begin(), x);
+		return;
+	}
+
+	FlistNode< T > *last;
+	myHead.next = mergeChains(myHead.next, static_cast< FlistNode< T > * >(lastNode()),
+		x.myHead.next, static_cast< FlistNode< T > * >(x.lastNode()), last, comp);
+	if constexpr (TrackTail)
+	{
+		this->myTail = last;
+		this->mySize += x.mySize;
+	}
+
+	release(x);
+}
+
+// Sorts the elements in the container, in ascending order (stable).
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::sort()
+{
+	sort(std::less< T >());
+}
+
+// Each pass splits the list into its ascending runs and merges them pairwise,
+// halving the number of runs, until the list is a single run.
+template< typename T, bool TrackTail >
+template< typename Compare >
+void forward_list< T, TrackTail >::sort(Compare comp)
+{
+	if (myHead.next == nullptr || myHead.next->next == nullptr)
+		return;
+
+	FlistNode< T > *last = nullptr;
+	unsigned int runs;
+	do
+	{
+		FlistNode< T > *rest = myHead.next;
+		FlistNode< T > *newHead = nullptr;
+		FlistNode< T > *newTail = nullptr;
+		runs = 0;
+		while (rest != nullptr)
+		{
+			FlistNode< T > *last1;
+			FlistNode< T > *last2 = nullptr;
+			FlistNode< T > *first1 = takeRun(rest, last1, rest, comp);
+			FlistNode< T > *first2 = nullptr;
+			if (rest != nullptr)
+				first2 = takeRun(rest, last2, rest, comp);
+
+			FlistNode< T > *merged = mergeChains(first1, last1, first2, last2, last, comp);
+			if (newTail == nullptr)
+				newHead = merged;
+			else
+				newTail->next = merged;
+			newTail = last;
+			runs++;
+		}
+		myHead.next = newHead;
+	} while (runs > 1);
+
+	if constexpr (TrackTail)
+		this->myTail = last;
+}
+
+// Detaches the ascending run starting at first.
+template< typename T, bool TrackTail >
+template< typename Compare >
+FlistNode< T > *forward_list< T, TrackTail >::takeRun(FlistNode< T > *first,
+	FlistNode< T > *&last, FlistNode< T > *&rest, Compare comp)
+{
+	last = first;
+	while (last->next != nullptr && !comp(last->next->myVal, last->myVal))
+		last = last->next;
+
+	rest = last->next;
+	last->next = nullptr;
+	return first;
+}
+
+// Merges the sorted chains [first1, last1] and [first2, last2].
+// Elements of the first chain precede equivalent elements of the second.
+template< typename T, bool TrackTail >
+template< typename Compare >
+FlistNode< T > *forward_list< T, TrackTail >::mergeChains(FlistNode< T > *first1,
+	FlistNode< T > *last1, FlistNode< T > *first2, FlistNode< T > *last2,
+	FlistNode< T > *&last, Compare comp)
+{
+	FlistNode< T > *head = nullptr;
+	FlistNode< T > **link = &head;
+	while (first1 != nullptr && first2 != nullptr)
+	{
+		if (comp(first2->myVal, first1->myVal))
+		{
+			*link = first2;
+			first2 = first2->next;
+		}
+		else
+		{
+			*link = first1;
+			first1 = first1->next;
+		}
+		link = &(*link)->next;
+	}
+
+	if (first1 != nullptr)
+	{
+		*link = first1;
+		last = last1;
+	}
+	else
+	{
+		*link = first2;
+		last = last2;
+	}
+
+	return head;
+}
+
+// Returns the last node of the forward_list container, or the before-begin node if empty.
+template< typename T, bool TrackTail >
+FlistLink< T > *forward_list< T, TrackTail >::lastNode() const
+{
+	if constexpr (TrackTail)
+		if (this->myTail != nullptr)
+			return this->myTail;
+
+	FlistLink< T > *p = before_begin().ptr;
+	while (p->next != nullptr)
+		p = p->next;
+	return p;
+}
+
+// Records that count nodes, ending with last, were linked into the container.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::linked(FlistNode< T > *last, unsigned int count)
+{
+	if constexpr (TrackTail)
+	{
+		if (last->next == nullptr)
+			this->myTail = last;
+		this->mySize += count;
+	}
+}
+
+// Records that count nodes were unlinked right after prev.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::unlinked(FlistLink< T > *prev, unsigned int count)
+{
+	if constexpr (TrackTail)
+	{
+		if (myHead.next == nullptr)
+			this->myTail = nullptr;
+		else if (prev->next == nullptr)
+			this->myTail = static_cast< FlistNode< T > * >(prev);
+		this->mySize -= count;
+	}
+}
+
+// Empties x after its nodes were moved into the container.
+template< typename T, bool TrackTail >
+void forward_list< T, TrackTail >::release(forward_list &x)
+{
+	x.myHead.next = nullptr;
+	if constexpr (TrackTail)
+	{
+		x.myTail = nullptr;
+		x.mySize = 0;
 	}
 }
 
 // determine if two lists are equal and return true, otherwise return false
-template< typename T >
-bool operator==(const forward_list< T > &lhs, const forward_list< T > &rhs)
+template< typename T, bool TrackTail >
+bool operator==(const forward_list< T, TrackTail > &lhs, const forward_list< T, TrackTail > &rhs)
 {
-	FlistNode< T > *p1 = lhs.myHead;
-	FlistNode< T > *p2 = rhs.myHead;
+	FlistNode< T > *p1 = lhs.myHead.next;
+	FlistNode< T > *p2 = rhs.myHead.next;
 	for (; p1 != nullptr && p2 != nullptr; p1 = p1->next, p2 = p2->next)
 		if (p1->myVal != p2->myVal)
 			return false;
@@ -319,17 +947,17 @@ bool operator==(const forward_list< T > &lhs, const forward_list< T > &rhs)
 }
 
 // inequality operator; returns opposite of == operator
-template< typename T >
-bool operator!=(const forward_list< T > &lhs, const forward_list< T > &rhs)
+template< typename T, bool TrackTail >
+bool operator!=(const forward_list< T, TrackTail > &lhs, const forward_list< T, TrackTail > &rhs)
 {
 	return !(lhs == rhs);
 }
 
 // determine if two lists are equal
-template< typename T >
-bool operator==(std::forward_list< T > &stdList, forward_list< T > &myList)
+template< typename T, bool TrackTail >
+bool operator==(std::forward_list< T > &stdList, forward_list< T, TrackTail > &myList)
 {
-	FlistNode< T > *ptr = myList.myHead;
+	FlistNode< T > *ptr = myList.myHead.next;
 	typename std::forward_list< T >::iterator it = stdList.begin();
 	for (; ptr != nullptr && it != stdList.end(); ptr = ptr->next, ++it)
 		if (ptr->myVal != *it)
@@ -0,0 +1,189 @@
+#ifndef HASH_H
+#define HASH_H
+
+#include <cstddef>     // size_t
+#include <cstdint>     // uint32_t, uint64_t
+#include <cstring>     // memcpy
+#include <functional>  // std::hash
+#include <string>      // std::basic_string
+#include <type_traits> // std::is_integral, std::is_enum, std::is_pointer, std::is_trivially_copyable
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h> // _umul128
+#endif
+
+// Hash functors for the hash containers (unordered_set, flat_unordered_set).
+// fast_hash is the default: one 64x64->128 multiply-fold for integers and
+// a wyhash-style loop over 8-byte words for strings. fnv1a_hash is 32-bit FNV-1a,
+// the hash of the original unordered_set::hashSeq for keys below 2^31.
+
+// Returns the xor of the high and low halves of the 128-bit product a * b.
+inline uint64_t hashMum(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = static_cast<unsigned __int128>(a) * b;
+	return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+	uint64_t high;
+	uint64_t low = _umul128(a, b, &high);
+	return low ^ high;
+#else
+	uint64_t aHigh = a >> 32, aLow = static_cast<uint32_t>(a);
+	uint64_t bHigh = b >> 32, bLow = static_cast<uint32_t>(b);
+	uint64_t hh = aHigh * bHigh, hl = aHigh * bLow, lh = aLow * bHigh, ll = aLow * bLow;
+	uint64_t mid = (ll >> 32) + static_cast<uint32_t>(hl) + static_cast<uint32_t>(lh);
+	uint64_t low = (mid << 32) | static_cast<uint32_t>(ll);
+	uint64_t high = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+	return low ^ high;
+#endif
+}
+
+// Multiplier constants shared by the hash functions.
+const uint64_t hashSecret0 = 0xa0761d6478bd642fULL;
+const uint64_t hashSecret1 = 0xe7037ed1a0b428dbULL;
+const uint64_t hashSecret2 = 0x8ebc6af09c88c6e3ULL;
+const uint64_t hashSecret3 = 0x589965cc75374cc3ULL;
+
+inline uint64_t hashRead8(const unsigned char* p)
+{
+	uint64_t v;
+	std::memcpy(&v, p, 8);
+	return v;
+}
+
+inline uint64_t hashRead4(const unsigned char* p)
+{
+	uint32_t v;
+	std::memcpy(&v, p, 4);
+	return v;
+}
+
+// Hashes len bytes at key, 16 bytes (two 8-byte words) per multiply (wyhash structure).
+inline uint64_t hashBytes(const void* key, size_t len, uint64_t seed = 0)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(key);
+	seed ^= hashMum(seed ^ hashSecret0, hashSecret1);
+
+	uint64_t a, b;
+	if (len <= 16)
+	{
+		if (len >= 4)
+		{	// two overlapping 4-byte reads from each end cover 4 to 16 bytes
+			size_t shift = (len >> 3) << 2;
+			a = (hashRead4(p) << 32) | hashRead4(p + shift);
+			b = (hashRead4(p + len - 4) << 32) | hashRead4(p + len - 4 - shift);
+		}
+		else if (len > 0)
+		{
+			a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+			b = 0;
+		}
+		else
+			a = b = 0;
+	}
+	else
+	{
+		size_t i = len;
+		if (i > 48)
+		{	// three independent lanes of 16 bytes
+			uint64_t seed1 = seed, seed2 = seed;
+			do
+			{
+				seed = hashMum(hashRead8(p) ^ hashSecret1, hashRead8(p + 8) ^ seed);
+				seed1 = hashMum(hashRead8(p + 16) ^ hashSecret2, hashRead8(p + 24) ^ seed1);
+				seed2 = hashMum(hashRead8(p + 32) ^ hashSecret3, hashRead8(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= seed1 ^ seed2;
+		}
+		while (i > 16)
+		{
+			seed = hashMum(hashRead8(p) ^ hashSecret1, hashRead8(p + 8) ^ seed);
+			p += 16;
+			i -= 16;
+		}
+		a = hashRead8(p + i - 16);
+		b = hashRead8(p + i - 8);
+	}
+
+	return hashMum(hashMum(a ^ hashSecret1, b ^ seed) ^ hashSecret0 ^ len, hashSecret1);
+}
+
+// Mixes a 64-bit integer so that every output bit depends on every input bit.
+inline uint64_t hashMix(uint64_t x)
+{
+	return hashMum(x ^ hashSecret0, hashSecret1);
+}
+
+// fast_hash class template definition
+// Integers, enums and pointers are mixed directly; strings go through hashBytes;
+// any other type has its std::hash mixed.
+template< typename T, typename = void >
+struct fast_hash
+{
+	size_t operator()(const T& k) const
+	{
+		return static_cast<size_t>(hashMix(static_cast<uint64_t>(std::hash< T >()(k))));
+	}
+};
+
+template< typename T >
+struct fast_hash< T, typename std::enable_if< std::is_integral< T >::value
+	|| std::is_enum< T >::value || std::is_pointer< T >::value >::type >
+{
+	size_t operator()(const T& k) const
+	{
+		uint64_t bits = 0;
+		std::memcpy(&bits, &k, sizeof(T) < sizeof(bits) ? sizeof(T) : sizeof(bits));
+		return static_cast<size_t>(hashMix(bits));
+	}
+};
+
+template< typename CharT, typename Traits, typename Alloc >
+struct fast_hash< std::basic_string< CharT, Traits, Alloc >, void >
+{
+	size_t operator()(const std::basic_string< CharT, Traits, Alloc >& k) const
+	{
+		return static_cast<size_t>(hashBytes(k.data(), k.size() * sizeof(CharT)));
+	}
+};
+
+// Returns the 32-bit FNV-1a hash of len bytes at key.
+inline uint32_t fnv1aBytes(const void* key, size_t len)
+{
+	const unsigned char* p = static_cast<const unsigned char*>(key);
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < len; i++)
+		h = (h ^ p[i]) * 16777619u;
+	return h;
+}
+
+// fnv1a_hash class template definition
+// 32-bit FNV-1a over the bytes of the key (the characters, for strings). For
+// unsigned int keys below 2^31 this matches the old hashSeq, so those keys land
+// in the buckets they used to. The old code copied the key into an int and only
+// read its bits while that int was positive, so every key of 2^31 and above
+// hashed to the same value; those keys now spread like any other.
+template< typename T >
+struct fnv1a_hash
+{
+	static_assert(std::is_trivially_copyable< T >::value,
+		"fnv1a_hash hashes the object representation of T");
+
+	size_t operator()(const T& k) const
+	{
+		return fnv1aBytes(&k, sizeof(T));
+	}
+};
+
+template< typename CharT, typename Traits, typename Alloc >
+struct fnv1a_hash< std::basic_string< CharT, Traits, Alloc > >
+{
+	size_t operator()(const std::basic_string< CharT, Traits, Alloc >& k) const
+	{
+		return fnv1aBytes(k.data(), k.size() * sizeof(CharT));
+	}
+};
+
+#endif
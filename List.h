@@ -2,50 +2,149 @@
 #define LIST_H
 
 #include <list>
+#include <atomic>      // std::atomic
+#include <cstddef>     // size_t
+#include <cstdint>     // uintptr_t
+#include <iterator>    // std::iterator_traits, std::distance
+#include <new>         // ::operator new, ::operator delete, placement new, std::align_val_t
+#include <utility>     // std::forward, std::move
 
 // ListNode class template definition
 template< typename T >
 struct ListNode
 {
+   // constructs myVal in place from args; the head node is never constructed
+   template< typename... Args >
+   ListNode( ListNode *nextNode, ListNode *prevNode, Args&&... args )
+      : next( nextNode ),
+        myVal( std::forward< Args >( args )... ),
+        prev( prevNode )
+   {
+   }
+
    ListNode *next;
    T myVal;
    ListNode *prev;
 }; // end class template ListNode
 
 
+// Returns the smallest power of 2 of at least 1024 that is no less than bytes.
+constexpr size_t listGranuleSize( size_t bytes, size_t size = 1024 )
+{
+   return size >= bytes ? size : listGranuleSize( bytes, size * 2 );
+}
+
 // list class template definition
+// Nodes are carved out of blocks: a bulk insertion of n elements takes all of its
+// nodes from a single block, and erased nodes are kept on a free list for reuse.
+// A block is a run of granules aligned to their size, each starting with a header,
+// so a node finds its block by masking its address. The block counts its nodes
+// still held by some list, on its chain or its free list, or by a caller of
+// unlink, and returns itself to the allocator when the last one is released.
+// A node held by unlink keeps only its own block alive once the list is gone.
+// link takes back only nodes carved by the same list, so a list never holds a
+// node of another list's block and cannot keep a block of a dead list alive:
+// an element moving between lists is moved into a node of the destination.
+// clear() and the destructor release every node the list holds.
 template< typename T >
 class list
 {
 public:
    using iterator = ListNode< T > *;
-   using const_iterator = ListNode< T > * const;
+   using const_iterator = const ListNode< T > *;
 
    list(); // Constructs an empty list container, with no elements.
    list( unsigned int n ); // Constructs a list container with n elements.
 
+   // Constructs a list container with n elements, each a copy of val.
+   list( unsigned int n, const T &val );
+
+   // Constructs a list container with a copy of each of the elements
+   // in the range [first, last), in the same order.
+   template< typename InputIt,
+             typename = typename std::iterator_traits< InputIt >::iterator_category >
+   list( InputIt first, InputIt last );
+
    // Destroys all list elements,
    // and deallocates all the storage allocated by the list container.
    ~list();
 
    iterator begin(); // Returns a pointer pointing to the first element in the list container.
+   const_iterator begin() const;
 
    iterator end(); // Returns an pointer referring to the past-the-end element in the list container.
+   const_iterator end() const;
 
    bool empty() const; // Returns a bool value indicating whether the linked list is empty.
 
    // Returns the number of elements in the list container.
    unsigned int size() const;
 
+   // Replaces the contents of the list container with n copies of val /
+   // with copies of the elements in the range [first, last).
+   void assign( unsigned int n, const T &val );
+   template< typename InputIt,
+             typename = typename std::iterator_traits< InputIt >::iterator_category >
+   void assign( InputIt first, InputIt last );
+
    // The list container is extended by inserting a new element
    // before the element at the specified position.
    // This effectively increases the list size by one.
+   // Returns a pointer to the inserted element.
    iterator insert( const_iterator position, const T &val );
+   iterator insert( const_iterator position, T &&val );
+
+   // Inserts n copies of val / copies of the elements in the range [first, last)
+   // before the element at the specified position.
+   // The new nodes are linked in one pass as a single chain.
+   // Returns a pointer to the first inserted element, or position if none was inserted.
+   iterator insert( const_iterator position, unsigned int n, const T &val );
+   template< typename InputIt,
+             typename = typename std::iterator_traits< InputIt >::iterator_category >
+   iterator insert( const_iterator position, InputIt first, InputIt last );
+
+   // Inserts a new element constructed in place from args
+   // before the element at the specified position.
+   // Returns a pointer to the inserted element.
+   template< typename... Args >
+   iterator emplace( const_iterator position, Args&&... args );
+
+   // Inserts a new element constructed in place from args
+   // at the beginning / end of the list container.
+   template< typename... Args >
+   T& emplace_front( Args&&... args );
+   template< typename... Args >
+   T& emplace_back( Args&&... args );
+
+   // Inserts a copy of (or moves) val at the beginning / end of the list container.
+   void push_front( const T &val );
+   void push_front( T &&val );
+   void push_back( const T &val );
+   void push_back( T &&val );
 
    // Removes from the list container the element at the specified position.
    // This effectively reduces the list size by one.
+   // Returns a pointer to the element that followed the erased one.
    iterator erase( const_iterator position );
 
+   // Moves the element at it, which must belong to this list, so that it precedes
+   // position. Only links are changed: no element is copied or moved.
+   void splice( const_iterator position, const_iterator it );
+
+   // Unlinks the element at position without destroying it and returns its node.
+   // The caller owns the node until it passes it to link or to dispose.
+   iterator unlink( const_iterator position );
+
+   // Returns true if node was carved from a block of this list, so link accepts it.
+   bool owns( const_iterator node ) const;
+
+   // Links node, which came from unlink and which this list owns, before position.
+   // Returns node, which now belongs to this list.
+   iterator link( const_iterator position, iterator node );
+
+   // Destroys the element of node, which came from unlink, and releases the node.
+   static void dispose( iterator node );
+
    // Resizes the list container so that it contains n elements.
    // If n is smaller than the current list container mySize,
    // the content is reduced to its first n elements, removing those beyond.
@@ -54,7 +153,8 @@ public:
    // as many elements as needed to reach a mySize of n.
    void resize( unsigned int n );
 
-   // Removes all elements from the list container (which are destroyed).
+   // Removes all elements from the list container (which are destroyed),
+   // and returns all node blocks to the allocator.
    void clear();
 
    // determine if two lists are equal
@@ -65,41 +165,109 @@ private:
 
    // pointing to the past-the-end element in the list container
    ListNode< T > *myHead;
+
+   ListNode< T > *myFree; // unconstructed nodes available for reuse, linked by next
+   unsigned int myNextGranules; // granules in the next block, doubling up to maxBlockGranules
+
+   // header at the start of every granule of a block
+   struct BlockHeader
+   {
+      std::atomic< size_t > held; // in the first granule: nodes of the block not yet released
+      BlockHeader *first;          // header of the block's first granule
+      const list *owner;           // in the first granule: the list that carved the block
+   };
+
+   // allocates the head node, whose myVal is left unconstructed
+   static ListNode< T > *buyHeadNode();
+
+   // deallocates the head node without destroying its myVal
+   static void freeHeadNode( ListNode< T > *head );
+
+   // Returns a chain of n unconstructed nodes linked by next,
+   // taken from the free list first and then from one newly allocated block.
+   ListNode< T > *buyNodes( unsigned int n );
+
+   // Destroys the node's myVal and puts the node on the free list.
+   void freeNode( ListNode< T > *node );
+
+   // Returns the block node was carved from.
+   static BlockHeader *blockOf( ListNode< T > *node );
+
+   // Gives count nodes, whose myVals are destroyed, back to block,
+   // freeing the block if they were the last nodes held.
+   static void releaseNodes( BlockHeader *block, size_t count );
+
+   // Releases every node of the chain from first, linked by next up to stop.
+   static void releaseChain( ListNode< T > *first, ListNode< T > *stop );
+
+   // Constructs n elements into nodes taken from buyNodes,
+   // calling make( slot, prev ) to construct each node in place,
+   // then links the whole chain before position at once.
+   template< typename Make >
+   iterator insertChain( const_iterator position, unsigned int n, Make make );
+
+   template< typename InputIt >
+   iterator insertRange( const_iterator position, InputIt first, InputIt last,
+                         std::input_iterator_tag );
+   template< typename ForwardIt >
+   iterator insertRange( const_iterator position, ForwardIt first, ForwardIt last,
+                         std::forward_iterator_tag );
+
+   // Returns position as a mutable node pointer. A const_iterator only promises
+   // not to change the element; the members that take one as a position relink
+   // the node through this.
+   static iterator toIterator( const_iterator position );
+
+   // size of the header in front of each granule, rounded up to keep nodes aligned
+   static const size_t blockHeaderSize =
+      ( sizeof( BlockHeader ) + alignof( ListNode< T > ) - 1 ) / alignof( ListNode< T > )
+                                                             * alignof( ListNode< T > );
+
+   // size and alignment of a granule; room for at least four nodes
+   static const size_t granuleSize =
+      listGranuleSize( blockHeaderSize + 4 * sizeof( ListNode< T > ) );
+
+   static const size_t nodesPerGranule = ( granuleSize - blockHeaderSize ) / sizeof( ListNode< T > );
+
+   // Blocks grow one granule at a time up to this many, which keeps the alignment
+   // waste of the allocator small for lists built by single insertions.
+   static const unsigned int maxBlockGranules = 64;
 }; // end class template list
 
 
 // Constructs an empty list container, with no elements.
 template< typename T >
 list< T >::list()
-   : mySize( 0 )
+   : mySize( 0 ),
+     myHead( buyHeadNode() ),
+     myFree( nullptr ),
+     myNextGranules( 1 )
 {
-   myHead = new ListNode< T >;
-   myHead->myVal = T();
-   myHead->prev = myHead->next = myHead;
 }
 
 // Constructs a list container with n elements.
 template< typename T >
 list< T >::list( unsigned int n )
-   : mySize( n )
+   : list()
 {
-   myHead = new ListNode< T >;
-   myHead->myVal = T();
-   myHead->prev = myHead->next = myHead;
+   resize( n );
+}
 
-   ListNode< T > *newNode = nullptr;
-   if( n > 0 )
-   {
-      for( unsigned int i = 0; i < n; i++ )
-      {
-         newNode = new ListNode< T >;
-         newNode->myVal = T();
-         newNode->prev = myHead->prev;
-         myHead->prev->next = newNode;
-         myHead->prev = newNode;
-      }
-      newNode->next = myHead;
-   }
+// Constructs a list container with n elements, each a copy of val.
+template< typename T >
+list< T >::list( unsigned int n, const T &val )
+   : list()
+{
+   insert( myHead, n, val );
+}
+
+// Constructs a list container with a copy of each of the elements in [first, last).
+template< typename T >
+template< typename InputIt, typename >
+list< T >::list( InputIt first, InputIt last )
+   : list()
+{
+   insert( myHead, first, last );
 }
 
 // Destroys all list elements,
@@ -108,7 +276,7 @@ template< typename T >
 list< T >::~list()
 {
    clear();
-   delete myHead;
+   freeHeadNode( myHead );
 }
 
 // Returns a pointer pointing to the first element in the list container.
@@ -118,6 +286,12 @@ typename list< T >::iterator list< T >::begin()
    return myHead->next;
 }
 
+template< typename T >
+typename list< T >::const_iterator list< T >::begin() const
+{
+   return myHead->next;
+}
+
 // Returns an pointer referring to the past-the-end element in the list container.
 template< typename T >
 typename list< T >::iterator list< T >::end()
@@ -125,6 +299,18 @@ typename list< T >::iterator list< T >::end()
    return myHead;
 }
 
+template< typename T >
+typename list< T >::const_iterator list< T >::end() const
+{
+   return myHead;
+}
+
+template< typename T >
+typename list< T >::iterator list< T >::toIterator( const_iterator position )
+{
+   return const_cast< ListNode< T > * >( position );
+}
+
 // Returns a bool value indicating whether the linked list is empty.
 template< typename T >
 bool list< T >::empty() const
@@ -138,23 +324,141 @@ unsigned int list< T >::size() const
    return mySize;
 }
 
+// Replaces the contents of the list container with n copies of val.
+// Existing elements are assigned to first, so no nodes are allocated
+// unless the list grows.
+template< typename T >
+void list< T >::assign( unsigned int n, const T &val )
+{
+   ListNode< T > *p = myHead->next;
+   for( ; p != myHead && n > 0; p = p->next, n-- )
+      p->myVal = val;
+
+   if( n > 0 )
+      insert( myHead, n, val );
+   else
+      while( p != myHead )
+         p = erase( p );
+}
+
+// Replaces the contents of the list container with copies of the elements in [first, last).
+template< typename T >
+template< typename InputIt, typename >
+void list< T >::assign( InputIt first, InputIt last )
+{
+   ListNode< T > *p = myHead->next;
+   for( ; p != myHead && first != last; p = p->next, ++first )
+      p->myVal = *first;
+
+   if( first != last )
+      insert( myHead, first, last );
+   else
+      while( p != myHead )
+         p = erase( p );
+}
+
 // The list container is extended by inserting a new element
 // before the element at the specified position.
 // This effectively increases the list size by one.
 template< typename T >
 typename list< T >::iterator list< T >::insert( const_iterator position, const T &val )
 {
-	ListNode< T > *newNode = new ListNode< T >;
-	newNode->myVal = val;
+	return emplace( position, val );
+}
+
+template< typename T >
+typename list< T >::iterator list< T >::insert( const_iterator position, T &&val )
+{
+	return emplace( position, std::move( val ) );
+}
+
+// Inserts n copies of val before the element at the specified position.
+template< typename T >
+typename list< T >::iterator list< T >::insert( const_iterator position,
+                                                 unsigned int n, const T &val )
+{
+	return insertChain( position, n,
+		[ &val ]( ListNode< T > *slot, ListNode< T > *prev )
+		{
+			return ::new( static_cast< void * >( slot ) ) ListNode< T >( nullptr, prev, val );
+		} );
+}
 
-	newNode->prev = position->prev;
-	position->prev->next = newNode;
-	position->prev = newNode;
-	newNode->next = position;
+// Inserts copies of the elements in [first, last) before the element at the specified position.
+template< typename T >
+template< typename InputIt, typename >
+typename list< T >::iterator list< T >::insert( const_iterator position,
+                                                 InputIt first, InputIt last )
+{
+	return insertRange( position, first, last,
+		typename std::iterator_traits< InputIt >::iterator_category() );
+}
+
+// Inserts a new element constructed in place from args
+// before the element at the specified position.
+template< typename T >
+template< typename... Args >
+typename list< T >::iterator list< T >::emplace( const_iterator position, Args&&... args )
+{
+	ListNode< T > *pos = toIterator( position );
+
+	ListNode< T > *newNode = buyNodes( 1 );
+	try
+	{
+		::new( static_cast< void * >( newNode ) )
+			ListNode< T >( pos, pos->prev, std::forward< Args >( args )... );
+	}
+	catch( ... )
+	{
+		newNode->next = myFree;
+		myFree = newNode;
+		throw;
+	}
+
+	pos->prev->next = newNode;
+	pos->prev = newNode;
 
 	mySize++;
 
-	return position;
+	return newNode;
+}
+
+template< typename T >
+template< typename... Args >
+T& list< T >::emplace_front( Args&&... args )
+{
+	return emplace( myHead->next, std::forward< Args >( args )... )->myVal;
+}
+
+template< typename T >
+template< typename... Args >
+T& list< T >::emplace_back( Args&&... args )
+{
+	return emplace( myHead, std::forward< Args >( args )... )->myVal;
+}
+
+template< typename T >
+void list< T >::push_front( const T &val )
+{
+	emplace( myHead->next, val );
+}
+
+template< typename T >
+void list< T >::push_front( T &&val )
+{
+	emplace( myHead->next, std::move( val ) );
+}
+
+template< typename T >
+void list< T >::push_back( const T &val )
+{
+	emplace( myHead, val );
+}
+
+template< typename T >
+void list< T >::push_back( T &&val )
+{
+	emplace( myHead, std::move( val ) );
 }
 
 // Removes from the list container the element at the specified position.
@@ -162,44 +466,109 @@ typename list< T >::iterator list< T >::insert( const_iterator position, const T
 template< typename T >
 typename list< T >::iterator list< T >::erase( const_iterator position )
 {
-	iterator temp = position;
-	position->next->prev = position->prev;
-	position->prev->next = position->next;
+	ListNode< T > *pos = toIterator( position );
+
+	iterator next = pos->next;
+	pos->next->prev = pos->prev;
+	pos->prev->next = pos->next;
 
-	delete temp;
+	freeNode( pos );
 
 	mySize--;
-	return position;
+	return next;
+}
+
+// Moves the element at it so that it precedes position.
+template< typename T >
+void list< T >::splice( const_iterator position, const_iterator it )
+{
+   ListNode< T > *pos = toIterator( position );
+   ListNode< T > *node = toIterator( it );
+
+   if( node == pos || node->next == pos )
+      return;
+
+   node->next->prev = node->prev;
+   node->prev->next = node->next;
+
+   node->prev = pos->prev;
+   node->next = pos;
+   pos->prev->next = node;
+   pos->prev = node;
+}
+
+// Unlinks the element at position and returns its node without destroying it.
+template< typename T >
+typename list< T >::iterator list< T >::unlink( const_iterator position )
+{
+   ListNode< T > *node = toIterator( position );
+   node->next->prev = node->prev;
+   node->prev->next = node->next;
+   mySize--;
+   return node;
+}
+
+// A block remembers the list that carved it. A list at the address of a
+// destroyed one may claim that list's surviving blocks, which only means it
+// relinks their nodes instead of moving the elements; the count stays exact.
+template< typename T >
+bool list< T >::owns( const_iterator node ) const
+{
+   return blockOf( toIterator( node ) )->owner == this;
+}
+
+// Links node, which came from unlink and which this list owns, before position.
+template< typename T >
+typename list< T >::iterator list< T >::link( const_iterator position, iterator node )
+{
+   ListNode< T > *pos = toIterator( position );
+   node->prev = pos->prev;
+   node->next = pos;
+   pos->prev->next = node;
+   pos->prev = node;
+   mySize++;
+   return node;
+}
+
+// Destroys the element of node, which came from unlink, and releases the node.
+template< typename T >
+void list< T >::dispose( iterator node )
+{
+   node->~ListNode< T >();
+   releaseNodes( blockOf( node ), 1 );
 }
 
 // Resizes the list container so that it contains n elements.
+// Growing constructs all the new elements in one chain.
 template< typename T >
 void list< T >::resize( unsigned int n )
 {
-	while (n != mySize)
-	{
-		if (n > mySize)
-			insert(end(), T());
-		else
-			erase(myHead->prev);
-	}
+	if( n > mySize )
+		insertChain( myHead, n - mySize,
+			[]( ListNode< T > *slot, ListNode< T > *prev )
+			{
+				return ::new( static_cast< void * >( slot ) ) ListNode< T >( nullptr, prev );
+			} );
+	else
+		while( n != mySize )
+			erase( myHead->prev );
 }
 
 // Removes all elements from the list container (which are destroyed)
+// and releases every node the list holds.
 template< typename T >
 void list< T >::clear()
 {
-   if( mySize > 0 ) // the list is not empty
-   {
-      while( myHead->next != myHead )
-      {
-         myHead->next = myHead->next->next;
-         delete myHead->next->prev;
-      }
+   for( ListNode< T > *p = myHead->next; p != myHead; p = p->next )
+      p->myVal.~T();
+   releaseChain( myHead->next, myHead );
 
-      myHead->prev = myHead;
-      mySize = 0;
-   }
+   myHead->prev = myHead->next = myHead;
+   mySize = 0;
+
+   releaseChain( myFree, nullptr );
+   myFree = nullptr;
+   myNextGranules = 1;
 }
 
 // determine if two lists are equal
@@ -218,4 +587,224 @@ bool list< T >::equal( std::list< T > &stdList )
    return true;
 }
 
-#endif
\ No newline at end of file
+// allocates the head node, whose myVal is left unconstructed
+template< typename T >
+ListNode< T > *list< T >::buyHeadNode()
+{
+   ListNode< T > *head = static_cast< ListNode< T > * >( ::operator new( sizeof( ListNode< T > ) ) );
+   head->prev = head->next = head;
+   return head;
+}
+
+// deallocates the head node without destroying its myVal
+template< typename T >
+void list< T >::freeHeadNode( ListNode< T > *head )
+{
+   ::operator delete( head );
+}
+
+// Returns a chain of n unconstructed nodes linked by next.
+template< typename T >
+ListNode< T > *list< T >::buyNodes( unsigned int n )
+{
+   ListNode< T > *first = nullptr;
+   ListNode< T > **link = &first;
+   for( ; n > 0 && myFree != nullptr; n-- )
+   {
+      *link = myFree;
+      myFree = myFree->next;
+      link = &( *link )->next;
+   }
+
+   if( n > 0 )
+   {
+      size_t granules = ( n + nodesPerGranule - 1 ) / nodesPerGranule;
+      if( granules < myNextGranules )
+         granules = myNextGranules;
+
+      char *block;
+      try
+      {
+         block = static_cast< char * >(
+            ::operator new( granules * granuleSize, std::align_val_t( granuleSize ) ) );
+      }
+      catch( ... )
+      {
+         *link = myFree; // give back the nodes taken from the free list
+         myFree = first;
+         throw;
+      }
+      if( myNextGranules < maxBlockGranules )
+         myNextGranules *= 2;
+
+      BlockHeader *head = ::new( static_cast< void * >( block ) ) BlockHeader;
+      head->held.store( granules * nodesPerGranule, std::memory_order_relaxed );
+      head->owner = this;
+      for( size_t g = 0; g < granules; g++ )
+      {
+         char *granule = block + g * granuleSize;
+         BlockHeader *header = g == 0 ? head : ::new( static_cast< void * >( granule ) ) BlockHeader;
+         header->first = head;
+
+         // the first n nodes go to the caller, the rest to the free list
+         ListNode< T > *nodes = reinterpret_cast< ListNode< T > * >( granule + blockHeaderSize );
+         for( size_t i = 0; i < nodesPerGranule; i++ )
+            if( n > 0 )
+            {
+               *link = nodes + i;
+               link = &nodes[ i ].next;
+               n--;
+            }
+            else
+            {
+               nodes[ i ].next = myFree;
+               myFree = nodes + i;
+            }
+      }
+   }
+
+   *link = nullptr;
+   return first;
+}
+
+// Destroys the node's myVal and puts the node on the free list.
+template< typename T >
+void list< T >::freeNode( ListNode< T > *node )
+{
+   node->~ListNode< T >();
+   node->next = myFree;
+   myFree = node;
+}
+
+// The header of node's granule leads to the block's first granule.
+template< typename T >
+typename list< T >::BlockHeader *list< T >::blockOf( ListNode< T > *node )
+{
+   return reinterpret_cast< BlockHeader * >(
+      reinterpret_cast< uintptr_t >( node ) & ~static_cast< uintptr_t >( granuleSize - 1 ) )->first;
+}
+
+// Gives count nodes back to block, freeing it if they were the last ones held.
+template< typename T >
+void list< T >::releaseNodes( BlockHeader *block, size_t count )
+{
+   if( block->held.fetch_sub( count, std::memory_order_acq_rel ) == count )
+      ::operator delete( static_cast< void * >( block ), std::align_val_t( granuleSize ) );
+}
+
+// Nodes from one block tend to follow each other along the chain,
+// so they are given back with one update of the block's count per run.
+template< typename T >
+void list< T >::releaseChain( ListNode< T > *first, ListNode< T > *stop )
+{
+   BlockHeader *block = nullptr;
+   size_t count = 0;
+   for( ListNode< T > *p = first; p != stop; )
+   {
+      BlockHeader *nodeBlock = blockOf( p );
+      p = p->next; // read before the block can be freed
+      if( nodeBlock != block )
+      {
+         if( count != 0 )
+            releaseNodes( block, count );
+         block = nodeBlock;
+         count = 0;
+      }
+      count++;
+   }
+   if( count != 0 )
+      releaseNodes( block, count );
+}
+
+// Constructs n elements into one chain of nodes, then links the chain before position.
+template< typename T >
+template< typename Make >
+typename list< T >::iterator list< T >::insertChain( const_iterator position,
+                                                      unsigned int n, Make make )
+{
+	ListNode< T > *pos = toIterator( position );
+
+	if( n == 0 )
+		return pos;
+
+	ListNode< T > *slot = buyNodes( n );
+	ListNode< T > *first = nullptr;
+	ListNode< T > *last = nullptr;
+	while( slot != nullptr )
+	{
+		ListNode< T > *nextSlot = slot->next;
+		ListNode< T > *newNode;
+		try
+		{
+			newNode = make( slot, last );
+		}
+		catch( ... )
+		{
+			slot->next = nextSlot; // give back the unused nodes
+			while( slot->next != nullptr )
+				slot = slot->next;
+			slot->next = myFree;
+			myFree = slot;
+			while( last != nullptr ) // and the constructed ones
+			{
+				ListNode< T > *temp = last;
+				last = last->prev;
+				freeNode( temp );
+			}
+			throw;
+		}
+
+		if( last == nullptr )
+			first = newNode;
+		else
+			last->next = newNode;
+		last = newNode;
+		slot = nextSlot;
+	}
+
+	first->prev = pos->prev;
+	last->next = pos;
+	pos->prev->next = first;
+	pos->prev = last;
+	mySize += n;
+
+	return first;
+}
+
+// Inserts the elements of an input range one at a time,
+// since its length cannot be known in advance.
+template< typename T >
+template< typename InputIt >
+typename list< T >::iterator list< T >::insertRange( const_iterator position,
+   InputIt first, InputIt last, std::input_iterator_tag )
+{
+	ListNode< T > *pos = toIterator( position );
+
+	iterator result = pos;
+	if( first != last )
+	{
+		result = emplace( pos, *first );
+		for( ++first; first != last; ++first )
+			emplace( pos, *first );
+	}
+	return result;
+}
+
+// Inserts the elements of a forward range as a single chain.
+template< typename T >
+template< typename ForwardIt >
+typename list< T >::iterator list< T >::insertRange( const_iterator position,
+   ForwardIt first, ForwardIt last, std::forward_iterator_tag )
+{
+	unsigned int n = static_cast< unsigned int >( std::distance( first, last ) );
+	return insertChain( position, n,
+		[ &first ]( ListNode< T > *slot, ListNode< T > *prev )
+		{
+			ListNode< T > *newNode =
+				::new( static_cast< void * >( slot ) ) ListNode< T >( nullptr, prev, *first );
+			++first;
+			return newNode;
+		} );
+}
+
+#endif
@@ -0,0 +1,337 @@
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>             // std::atomic, std::atomic_thread_fence
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // size_t, ptrdiff_t
+#include <mutex>              // std::mutex
+#include <new>                // placement new
+#include <thread>             // std::this_thread::yield
+#include <type_traits>        // std::is_nothrow_constructible, std::aligned_storage
+#include <utility>            // std::forward, std::move
+
+// CLASS TEMPLATE mpmc_queue
+// Bounded lock-free FIFO queue for any number of producer and consumer threads
+// (Vyukov's array queue). The slots form a fixed power-of-2 ring allocated by the
+// constructor; each slot carries a sequence number telling which lap of the ring
+// may use it next:
+//   sequence == pos           the slot is free for the producer claiming position pos
+//   sequence == pos + 1       the slot holds the element at pos, ready for a consumer
+//   sequence == pos + size    the consumer of pos is done, free for the next lap
+// A thread claims a position with one CAS on the shared back or front counter and
+// then owns the slot, so producers and consumers only contend on their own counter.
+// The blocking members spin briefly, then sleep on a condition variable; the mutex
+// is only touched when some thread is asleep.
+template< class Ty >
+class mpmc_queue
+{
+public:
+	using value_type = Ty;
+	using size_type  = size_t;
+
+	static_assert(std::is_nothrow_move_constructible< Ty >::value,
+		"mpmc_queue requires a nothrow move constructor");
+
+	// construct a queue holding at least count elements, rounded up to a power of 2
+	explicit mpmc_queue(size_type count)
+		: slots(nullptr),
+		slotMask(0)
+	{
+		size_type size = 1;
+		while (size < count)
+			size *= 2;
+
+		slots = new Slot[size];
+		slotMask = size - 1;
+		for (size_type i = 0; i < size; i++)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	mpmc_queue(const mpmc_queue&) = delete;
+	mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+	// destroy the remaining elements; no thread may be using the queue any more
+	~mpmc_queue()
+	{
+		size_type back = myBack.load(std::memory_order_relaxed);
+		for (size_type pos = myFront.load(std::memory_order_relaxed); pos != back; ++pos)
+			slots[pos & slotMask].elem()->~Ty();
+		delete[] slots;
+	}
+
+	// return the maximum number of elements the queue can hold
+	size_type capacity() const
+	{
+		return slotMask + 1;
+	}
+
+	// return the number of claimed positions at the time of the call; approximate
+	// while other threads are pushing or popping
+	size_type size() const
+	{
+		ptrdiff_t count = static_cast<ptrdiff_t>(myBack.load(std::memory_order_acquire)
+			- myFront.load(std::memory_order_acquire));
+		return count > 0 ? static_cast<size_type>(count) : 0;
+	}
+
+	// test if the queue was empty at the time of the call; same caveat as size
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// append val; returns false if the queue is full
+	bool try_push_back(const Ty& val)
+	{
+		return try_emplace_back(val);
+	}
+
+	bool try_push_back(Ty&& val)
+	{
+		return try_emplace_back(std::move(val));
+	}
+
+	// append an element constructed in place from args; returns false,
+	// consuming nothing, if the queue is full
+	template< class... Args >
+	bool try_emplace_back(Args&&... args)
+	{
+		if (!claimEmplace(std::is_nothrow_constructible< Ty, Args&&... >(),
+			std::forward< Args >(args)...))
+			return false;
+
+		wakeOne(emptyWaiters, notEmpty);
+		return true;
+	}
+
+	// move the first element into val and remove it; returns false if the queue is empty
+	bool try_pop_front(Ty& val)
+	{
+		bool popped;
+		try
+		{
+			popped = claimPop(val);
+		}
+		catch (...)
+		{
+			wakeOne(fullWaiters, notFull);
+			throw;
+		}
+
+		if (popped)
+			wakeOne(fullWaiters, notFull);
+		return popped;
+	}
+
+	// append val, waiting while the queue is full
+	void push_back(const Ty& val)
+	{
+		emplace_back(val);
+	}
+
+	void push_back(Ty&& val)
+	{
+		emplace_back(std::move(val));
+	}
+
+	// append an element constructed in place from args, waiting while the queue is full
+	template< class... Args >
+	void emplace_back(Args&&... args)
+	{
+		emplaceWait(std::is_nothrow_constructible< Ty, Args&&... >(),
+			std::forward< Args >(args)...);
+	}
+
+	// move the first element into val and remove it, waiting while the queue is empty
+	void pop_front(Ty& val)
+	{
+		waitUntil(emptyWaiters, notEmpty, fullWaiters, notFull,
+			[&] { return claimPop(val); });
+	}
+
+private:
+	struct Slot
+	{
+		std::atomic< size_type > sequence;
+		typename std::aligned_storage< sizeof(Ty), alignof(Ty) >::type storage;
+
+		Ty* elem()
+		{
+			return reinterpret_cast<Ty*>(&storage);
+		}
+	};
+
+	// claim the back position and construct the element in place;
+	// the claim* members leave waking the other side to their callers
+	template< class... Args >
+	bool claimEmplace(std::true_type, Args&&... args)
+	{
+		size_type pos = myBack.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &slots[pos & slotMask];
+			size_type seq = slot->sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff = static_cast<ptrdiff_t>(seq - pos);
+			if (diff == 0)
+			{
+				if (myBack.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = myBack.load(std::memory_order_relaxed);
+		}
+
+		::new (static_cast<void*>(slot->elem())) Ty(std::forward< Args >(args)...);
+		slot->sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// a claimed slot cannot be given back, so build a construction that may throw
+	// first and move it in
+	template< class... Args >
+	bool claimEmplace(std::false_type, Args&&... args)
+	{
+		Ty val(std::forward< Args >(args)...);
+		return claimEmplace(std::true_type(), std::move(val));
+	}
+
+	// claim the front position and move its element into val
+	bool claimPop(Ty& val)
+	{
+		size_type pos = myFront.load(std::memory_order_relaxed);
+		Slot* slot;
+		for (;;)
+		{
+			slot = &slots[pos & slotMask];
+			size_type seq = slot->sequence.load(std::memory_order_acquire);
+			ptrdiff_t diff = static_cast<ptrdiff_t>(seq - (pos + 1));
+			if (diff == 0)
+			{
+				if (myFront.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				pos = myFront.load(std::memory_order_relaxed);
+		}
+
+		Ty* elem = slot->elem();
+		try
+		{
+			val = std::move(*elem);
+		}
+		catch (...)
+		{	// the element is lost, but the slot must go back to the producers
+			release(slot, elem, pos);
+			throw;
+		}
+		release(slot, elem, pos);
+		return true;
+	}
+
+	template< class... Args >
+	void emplaceWait(std::true_type, Args&&... args)
+	{	// args are only consumed by the attempt that succeeds
+		waitUntil(fullWaiters, notFull, emptyWaiters, notEmpty,
+			[&] { return claimEmplace(std::true_type(), std::forward< Args >(args)...); });
+	}
+
+	template< class... Args >
+	void emplaceWait(std::false_type, Args&&... args)
+	{
+		Ty val(std::forward< Args >(args)...);
+		emplaceWait(std::true_type(), std::move(val));
+	}
+
+	// destroy the element of a consumed slot and hand the slot to the next lap
+	void release(Slot* slot, Ty* elem, size_type pos)
+	{
+		elem->~Ty();
+		slot->sequence.store(pos + slotMask + 1, std::memory_order_release);
+	}
+
+	// call attempt until it succeeds: spin a little, then sleep on cond;
+	// afterwards wake one sleeper of the other side on otherCond
+	template< class Func >
+	void waitUntil(std::atomic< size_type >& waiters, std::condition_variable& cond,
+		std::atomic< size_type >& otherWaiters, std::condition_variable& otherCond, Func attempt)
+	{
+		for (int spin = 0; spin < spinLimit; spin++)
+		{
+			bool done;
+			try
+			{
+				done = attempt();
+			}
+			catch (...)
+			{
+				wakeOne(otherWaiters, otherCond);
+				throw;
+			}
+
+			if (done)
+			{
+				wakeOne(otherWaiters, otherCond);
+				return;
+			}
+			std::this_thread::yield();
+		}
+
+		std::unique_lock< std::mutex > lock(waitMutex);
+		waiters.fetch_add(1);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		try
+		{
+			cond.wait(lock, attempt);
+		}
+		catch (...)
+		{
+			waiters.fetch_sub(1);
+			wakeLocked(otherWaiters, otherCond);
+			throw;
+		}
+		waiters.fetch_sub(1);
+		wakeLocked(otherWaiters, otherCond);
+	}
+
+	// wake one sleeper on cond, if any. The fences here and in waitUntil order the
+	// slot update against the waiter count: either the sleeper's retry sees the
+	// update or this sees the sleeper.
+	void wakeOne(std::atomic< size_type >& waiters, std::condition_variable& cond)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) == 0)
+			return;
+
+		std::lock_guard< std::mutex > lock(waitMutex);
+		cond.notify_one();
+	}
+
+	// same as wakeOne, for a caller already holding waitMutex
+	void wakeLocked(std::atomic< size_type >& waiters, std::condition_variable& cond)
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (waiters.load(std::memory_order_relaxed) != 0)
+			cond.notify_one();
+	}
+
+	static const int spinLimit = 64;
+
+	Slot* slots;        // ring of capacity() slots, never reallocated
+	size_type slotMask; // capacity() - 1
+
+	alignas(64) std::atomic< size_type > myBack{ 0 };  // next position to claim for a push
+	alignas(64) std::atomic< size_type > myFront{ 0 }; // next position to claim for a pop
+
+	alignas(64) std::mutex waitMutex;             // guards the sleeps below
+	std::condition_variable notFull;              // producers waiting for a free slot
+	std::condition_variable notEmpty;             // consumers waiting for an element
+	std::atomic< size_type > fullWaiters{ 0 };    // producers asleep on notFull
+	std::atomic< size_type > emptyWaiters{ 0 };   // consumers asleep on notEmpty
+};
+
+#endif
@@ -0,0 +1,468 @@
+#ifndef PERSISTENT_DEQUE_H
+#define PERSISTENT_DEQUE_H
+
+#include <cerrno>       // errno
+#include <cstddef>      // size_t, offsetof
+#include <cstdint>      // uint64_t
+#include <cstdio>       // snprintf, sscanf
+#include <cstring>      // memcpy
+#include <stdexcept>    // std::runtime_error
+#include <string>       // std::string
+#include <system_error> // std::system_error
+#include <type_traits>  // std::is_trivially_copyable
+#include <vector>       // std::vector
+
+#include <dirent.h>   // opendir, readdir
+#include <fcntl.h>    // open, posix_fallocate
+#include <sys/mman.h> // mmap, msync, munmap
+#include <sys/stat.h> // mkdir
+#include <unistd.h>   // close, fsync, pread, pwrite, unlink
+
+#include "Deque.h" // include definition of class template deque, dequeFloorPow2, dequeLog2
+
+// Number of elements per segment file of a persistent_deque: the largest
+// power of 2 whose segment fits in 1 MB, so a segment is a few hundred pages.
+template< class Ty >
+struct PersistentSegmentSize
+{
+	static const size_t value = sizeof(Ty) <= (1 << 20) ? dequeFloorPow2((1 << 20) / sizeof(Ty)) : 1;
+};
+
+// CLASS TEMPLATE persistent_deque
+// FIFO append log of trivially copyable elements kept in a directory of
+// memory-mapped segment files, for queues that must survive a restart.
+// Like deque, positions are free-running counters split into a block number and
+// an offset: position pos lives in segment file pos >> segmentShift, at element
+// pos & segmentMask, and the mapped segments are kept in a deque ordered by number.
+// The durable state is the pair (head, tail) in the meta file, written to one of
+// two checksummed slots in turn so that a torn write leaves the other intact.
+// sync() makes everything up to the current tail durable: it flushes the
+// segment pages written since the last sync, then the directory if files were
+// added, then the meta file. It runs after every syncEvery push_back/pop_front
+// calls (0: only when called explicitly, and from the destructor).
+// A segment is recycled only once a durable head has passed it: the first
+// spareLimit are renamed to spare files and reused for new segments, the rest
+// are deleted. On restart the (head, tail) of the newest valid slot is recovered
+// and any other segment file is recycled the same way.
+// POSIX only (mmap, msync, fsync).
+template< class Ty, size_t SegmentSize = PersistentSegmentSize< Ty >::value >
+class persistent_deque
+{
+public:
+	using value_type      = Ty;
+	using size_type       = size_t;
+	using const_reference = const Ty&;
+
+	static_assert(std::is_trivially_copyable< Ty >::value,
+		"persistent_deque requires a trivially copyable element type");
+
+	// open the queue stored in directory, creating it if needed, and recover
+	// the elements of the last sync
+	explicit persistent_deque(const std::string& directory, size_type syncEvery = 1)
+		: dir(directory),
+		metaFd(-1),
+		syncEvery(syncEvery),
+		unsynced(0),
+		sequence(0),
+		head(0),
+		tail(0),
+		syncedTail(0),
+		frontIndex(0),
+		spareSerial(0),
+		newFiles(false)
+	{
+		try
+		{
+			recover();
+		}
+		catch (...)
+		{
+			release();
+			throw;
+		}
+	}
+
+	persistent_deque(const persistent_deque&) = delete;
+	persistent_deque& operator=(const persistent_deque&) = delete;
+
+	// sync, then unmap the segments; a failing sync is ignored here,
+	// call sync() first to see it
+	~persistent_deque()
+	{
+		try
+		{
+			sync();
+		}
+		catch (...)
+		{
+		}
+		release();
+	}
+
+	// return length of sequence
+	size_type size() const
+	{
+		return static_cast<size_type>(tail - head);
+	}
+
+	// test if sequence is empty
+	bool empty() const
+	{
+		return tail == head;
+	}
+
+	const_reference operator[](size_type pos) const
+	{
+		return at(head + pos);
+	}
+
+	const_reference front() const
+	{
+		return at(head);
+	}
+
+	const_reference back() const
+	{
+		return at(tail - 1);
+	}
+
+	// return the number of calls between automatic syncs, 0 if none
+	size_type sync_every() const
+	{
+		return syncEvery;
+	}
+
+	void set_sync_every(size_type count)
+	{
+		syncEvery = count;
+	}
+
+	// append val to the tail segment, starting a new segment if it is full
+	void push_back(const Ty& val)
+	{
+		uint64_t index = tail >> segmentShift;
+		if (segments.empty())
+			frontIndex = index;
+		if (index == frontIndex + segments.size())
+			addSegment(index);
+
+		std::memcpy(static_cast<void*>(segments[static_cast<size_type>(index - frontIndex)]
+			+ (tail & segmentMask)), &val, sizeof(Ty));
+		++tail;
+		noteChange();
+	}
+
+	// erase the first element; the segment is retired once the head leaves it
+	void pop_front()
+	{
+		if ((++head & segmentMask) == 0)
+			retireFront();
+		noteChange();
+	}
+
+	// make the current contents durable
+	void sync()
+	{
+		if (tail != syncedTail)
+		{	// flush the pages written since the last sync
+			uint64_t first = syncedTail >> segmentShift;
+			uint64_t last = (tail - 1) >> segmentShift;
+			if (first < frontIndex)
+				first = frontIndex;
+			for (uint64_t index = first; index <= last; ++index)
+				if (::msync(segments[static_cast<size_type>(index - frontIndex)],
+					segmentBytes, MS_SYNC) != 0)
+					fail("msync");
+		}
+
+		if (newFiles)
+		{	// the segments the meta file will refer to must have durable names
+			syncDirectory();
+			newFiles = false;
+		}
+
+		writeMeta();
+		syncedTail = tail;
+		unsynced = 0;
+
+		// the durable head has passed the retired segments
+		for (size_type i = 0; i < retired.size(); i++)
+			recycle(retired[i]);
+		retired.clear();
+	}
+
+private:
+	static const size_type segmentSize  = SegmentSize;
+	static const size_type segmentShift = dequeLog2(SegmentSize);
+	static const uint64_t  segmentMask  = SegmentSize - 1;
+	static const size_type segmentBytes = SegmentSize * sizeof(Ty);
+
+	static_assert((segmentSize & (segmentSize - 1)) == 0,
+		"persistent_deque segment size must be a power of 2");
+
+	// maximum number of consumed segment files kept for reuse instead of being deleted
+	static const size_type spareLimit = 2;
+
+	static const uint64_t metaMagic = 0x5144534550ULL; // "PESDQ"
+
+	// one of the two copies of the durable state in the meta file
+	struct MetaSlot
+	{
+		uint64_t magic;
+		uint64_t sequence; // the valid slot with the larger sequence wins
+		uint64_t elemSize;
+		uint64_t segmentSize;
+		uint64_t head;
+		uint64_t tail;
+		uint64_t checksum; // FNV-1a of the fields above
+	};
+
+	[[noreturn]] static void fail(const char* what)
+	{
+		throw std::system_error(errno, std::generic_category(),
+			std::string("persistent_deque: ") + what);
+	}
+
+	static uint64_t checksum(const MetaSlot& slot)
+	{
+		const unsigned char* p = reinterpret_cast<const unsigned char*>(&slot);
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < offsetof(MetaSlot, checksum); i++)
+			hash = (hash ^ p[i]) * 1099511628211ULL;
+		return hash;
+	}
+
+	std::string path(const std::string& name) const
+	{
+		return dir + "/" + name;
+	}
+
+	static std::string segmentName(uint64_t index)
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "seg-%016llx.dat", static_cast<unsigned long long>(index));
+		return name;
+	}
+
+	std::string newSpareName()
+	{
+		char name[32];
+		std::snprintf(name, sizeof(name), "spare-%016llx.dat",
+			static_cast<unsigned long long>(spareSerial++));
+		return name;
+	}
+
+	// return the element at position pos, which must be in a mapped segment
+	const Ty& at(uint64_t pos) const
+	{
+		return segments[static_cast<size_type>((pos >> segmentShift) - frontIndex)][pos & segmentMask];
+	}
+
+	// count one change toward the next automatic sync
+	void noteChange()
+	{
+		if (syncEvery != 0 && ++unsynced >= syncEvery)
+			sync();
+	}
+
+	// map the segment file name, creating it with a full segment of storage if create.
+	// The storage is reserved, not just sized: a store through the mapping to a
+	// page of a sparse file raises SIGBUS on a full disk instead of failing, so
+	// the disk filling up is reported here as ENOSPC. Existing segments are
+	// reserved too, since a file left sparse by a crash has the same hazard.
+	Ty* mapSegment(const std::string& name, bool create)
+	{
+		int fd = ::open(path(name).c_str(), create ? O_RDWR | O_CREAT : O_RDWR, 0666);
+		if (fd < 0)
+			fail("open segment");
+
+		struct stat info;
+		if (::fstat(fd, &info) != 0)
+		{
+			::close(fd);
+			fail("size segment");
+		}
+		if (!create && static_cast<size_type>(info.st_size) < segmentBytes)
+		{
+			::close(fd);
+			throw std::runtime_error("persistent_deque: truncated segment " + name);
+		}
+		int error = ::posix_fallocate(fd, 0, static_cast<off_t>(segmentBytes));
+		if (error != 0)
+		{
+			::close(fd);
+			if (create && info.st_size == 0) // leave no empty segment behind
+				::unlink(path(name).c_str());
+			errno = error;
+			fail("posix_fallocate segment");
+		}
+
+		void* addr = ::mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		::close(fd); // the mapping keeps the file open
+		if (addr == MAP_FAILED)
+			fail("mmap");
+		return static_cast<Ty*>(addr);
+	}
+
+	// start segment index at the back, from a spare file if there is one
+	void addSegment(uint64_t index)
+	{
+		std::string name = segmentName(index);
+		if (!spares.empty())
+		{
+			if (::rename(path(spares.back()).c_str(), path(name).c_str()) != 0)
+				fail("rename spare");
+			spares.pop_back();
+		}
+
+		segments.push_back(mapSegment(name, true));
+		newFiles = true;
+	}
+
+	// unmap the fully consumed front segment; its file is recycled by the next sync
+	void retireFront()
+	{
+		::munmap(segments.front(), segmentBytes);
+		segments.pop_front();
+		retired.push_back(segmentName(frontIndex));
+		++frontIndex;
+	}
+
+	// keep the unused segment file name as a spare, or delete it
+	void recycle(const std::string& name)
+	{
+		if (spares.size() < spareLimit)
+		{
+			std::string spare = newSpareName();
+			if (::rename(path(name).c_str(), path(spare).c_str()) == 0)
+			{
+				spares.push_back(spare);
+				return;
+			}
+		}
+		::unlink(path(name).c_str());
+	}
+
+	void syncDirectory()
+	{
+		int fd = ::open(dir.c_str(), O_RDONLY);
+		if (fd < 0)
+			fail("open directory");
+		int result = ::fsync(fd);
+		::close(fd);
+		if (result != 0)
+			fail("fsync directory");
+	}
+
+	// write (head, tail) to the older slot of the meta file and flush it
+	void writeMeta()
+	{
+		MetaSlot slot = { metaMagic, sequence + 1, sizeof(Ty), segmentSize, head, tail, 0 };
+		slot.checksum = checksum(slot);
+
+		off_t where = static_cast<off_t>((slot.sequence & 1) * sizeof(MetaSlot));
+		if (::pwrite(metaFd, &slot, sizeof(slot), where) != static_cast<ssize_t>(sizeof(slot))
+			|| ::fsync(metaFd) != 0)
+			fail("write meta");
+		++sequence;
+	}
+
+	// load the newest valid meta slot, map the live segments, recycle the other files
+	void recover()
+	{
+		if (::mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST)
+			fail("mkdir");
+
+		metaFd = ::open(path("meta").c_str(), O_RDWR | O_CREAT, 0666);
+		if (metaFd < 0)
+			fail("open meta");
+
+		MetaSlot slots[2];
+		bool found = false;
+		for (int i = 0; i < 2; i++)
+		{
+			if (::pread(metaFd, &slots[i], sizeof(MetaSlot), static_cast<off_t>(i * sizeof(MetaSlot)))
+				!= static_cast<ssize_t>(sizeof(MetaSlot))
+				|| slots[i].magic != metaMagic || slots[i].checksum != checksum(slots[i])
+				|| slots[i].head > slots[i].tail)
+				continue;
+
+			if (slots[i].elemSize != sizeof(Ty) || slots[i].segmentSize != segmentSize)
+				throw std::runtime_error("persistent_deque: " + dir + " has a different element or segment size");
+
+			if (!found || slots[i].sequence > sequence)
+			{
+				sequence = slots[i].sequence;
+				head = slots[i].head;
+				tail = slots[i].tail;
+				found = true;
+			}
+		}
+		syncedTail = tail;
+		frontIndex = head >> segmentShift;
+
+		// sort the directory: live segments are mapped, everything else is recycled
+		std::vector< std::string > stale;
+		DIR* listing = ::opendir(dir.c_str());
+		if (listing == nullptr)
+			fail("opendir");
+		while (dirent* entry = ::readdir(listing))
+		{
+			unsigned long long number;
+			char tailChar;
+			if (std::sscanf(entry->d_name, "spare-%llx.dat%c", &number, &tailChar) == 1)
+			{
+				if (number >= spareSerial)
+					spareSerial = number + 1;
+				stale.push_back(entry->d_name);
+			}
+			else if (std::sscanf(entry->d_name, "seg-%llx.dat%c", &number, &tailChar) == 1
+				&& (head == tail || number < frontIndex || number > ((tail - 1) >> segmentShift)))
+				stale.push_back(entry->d_name);
+		}
+		::closedir(listing);
+
+		if (head != tail)
+		{
+			uint64_t last = (tail - 1) >> segmentShift;
+			for (uint64_t index = frontIndex; index <= last; ++index)
+				segments.push_back(mapSegment(segmentName(index), false));
+		}
+
+		for (size_type i = 0; i < stale.size(); i++)
+			recycle(stale[i]);
+	}
+
+	// unmap every segment and close the meta file
+	void release()
+	{
+		while (!segments.empty())
+		{
+			::munmap(segments.front(), segmentBytes);
+			segments.pop_front();
+		}
+		if (metaFd >= 0)
+			::close(metaFd);
+		metaFd = -1;
+	}
+
+	std::string dir;
+	int metaFd;
+
+	size_type syncEvery; // changes between automatic syncs, 0 for none
+	size_type unsynced;  // changes since the last sync
+	uint64_t sequence;   // sequence of the last meta slot written
+
+	uint64_t head;       // position of the first element
+	uint64_t tail;       // position past the last element
+	uint64_t syncedTail; // tail at the last sync
+
+	deque< Ty* > segments;            // mapped segments frontIndex, frontIndex + 1, ...
+	uint64_t frontIndex;              // segment number of segments.front()
+	std::vector< std::string > retired; // consumed segment files awaiting a durable head
+	std::vector< std::string > spares;  // recycled segment files for reuse
+	uint64_t spareSerial;             // number for the next spare file name
+	bool newFiles;                    // files added since the last directory sync
+};
+
+#endif
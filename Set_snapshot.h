@@ -0,0 +1,389 @@
+#ifndef SET_SNAPSHOT_H
+#define SET_SNAPSHOT_H
+
+#include <cerrno>       // errno
+#include <cstddef>      // size_t, offsetof
+#include <cstdint>      // uint32_t, uint64_t
+#include <cstdio>       // rename
+#include <cstring>      // memcmp, memcpy
+#include <functional>   // std::equal_to
+#include <stdexcept>    // std::runtime_error
+#include <string>       // std::string
+#include <system_error> // std::system_error
+#include <type_traits>  // std::is_trivially_copyable
+#include <utility>      // std::swap
+#include <vector>       // std::vector
+
+#include <fcntl.h>    // open, posix_fallocate
+#include <sys/mman.h> // mmap, msync, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h>   // close, fsync, unlink
+
+#include "Hash.h"          // fast_hash, fnv1aBytes
+#include "Unordered_set.h" // include definition of class template unordered_set
+
+// CLASS TEMPLATE set_snapshot
+// Read-only hash set served straight from a memory-mapped file, so a large
+// lookup set is loaded by one mmap instead of being rebuilt. save() writes the
+// file; the constructor maps it and checks its header, and find reads the
+// mapping in place. The layout uses file offsets only, so it does not depend
+// on where it is mapped:
+//   header      magic, version, key size, counts, section offsets, checksum
+//   offsets     bucketCount + 1 uint64_t: the keys of bucket b are
+//               keys[offsets[b], offsets[b + 1])
+//   keys        the packed keys, grouped by bucket
+// A key's bucket is its hash masked to the power-of-2 bucket count, chosen for
+// about 2 keys per bucket, so a lookup reads one offsets line and one keys line.
+// The file must be read with the same Hash, key type and byte order it was
+// written with. Only the header is checked, plus the first key to catch a
+// different Hash; the rest of the file is trusted.
+// Keys must be trivially copyable. POSIX only (mmap).
+template< class T, class Hash = fast_hash< T >, class KeyEqual = std::equal_to< T > >
+class set_snapshot
+{
+public:
+	using value_type = T;
+	using size_type  = size_t;
+	using iterator   = const T*;
+
+	static_assert(std::is_trivially_copyable< T >::value,
+		"set_snapshot requires a trivially copyable key type");
+
+	// write the count distinct keys at keys to path, replacing it atomically
+	static void save(const std::string& path, const T* keys, size_type count,
+		const Hash& hash = Hash())
+	{
+		build(path, count, hash, [&](auto&& visit)
+		{
+			for (size_type i = 0; i < count; i++)
+				visit(keys[i]);
+		});
+	}
+
+	// write the elements of set to path, replacing it atomically
+	static void save(const std::string& path, unordered_set< T, Hash, KeyEqual >& set)
+	{
+		build(path, set.size(), set.hash_function(), [&](auto&& visit)
+		{
+			for (auto p = set.begin(); p != set.end(); p = p->next)
+				visit(p->myVal);
+		});
+	}
+
+	// map the snapshot at path
+	explicit set_snapshot(const std::string& path, const Hash& hash = Hash(),
+		const KeyEqual& equal = KeyEqual())
+		: base(nullptr),
+		length(0),
+		offsets(nullptr),
+		keys(nullptr),
+		count(0),
+		mask(0),
+		myHash(hash),
+		myEqual(equal)
+	{
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			fail("open");
+
+		struct stat info;
+		if (::fstat(fd, &info) != 0)
+		{
+			::close(fd);
+			fail("fstat");
+		}
+		length = static_cast<size_t>(info.st_size);
+		if (length < sizeof(Header))
+		{
+			::close(fd);
+			throw std::runtime_error("set_snapshot: " + path + " is truncated");
+		}
+
+		void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (mapping == MAP_FAILED)
+			fail("mmap");
+		base = static_cast<const unsigned char*>(mapping);
+
+		try
+		{
+			attach(path);
+		}
+		catch (...)
+		{
+			::munmap(const_cast<unsigned char*>(base), length);
+			throw;
+		}
+	}
+
+	set_snapshot(set_snapshot&& right) noexcept
+		: base(right.base),
+		length(right.length),
+		offsets(right.offsets),
+		keys(right.keys),
+		count(right.count),
+		mask(right.mask),
+		myHash(right.myHash),
+		myEqual(right.myEqual)
+	{
+		right.base = nullptr;
+		right.length = 0;
+		right.offsets = nullptr;
+		right.keys = nullptr;
+		right.count = 0;
+		right.mask = 0;
+	}
+
+	set_snapshot& operator=(set_snapshot right) noexcept
+	{
+		swap(right);
+		return *this;
+	}
+
+	set_snapshot(const set_snapshot&) = delete;
+
+	~set_snapshot()
+	{
+		if (base != nullptr)
+			::munmap(const_cast<unsigned char*>(base), length);
+	}
+
+	void swap(set_snapshot& right) noexcept
+	{
+		std::swap(base, right.base);
+		std::swap(length, right.length);
+		std::swap(offsets, right.offsets);
+		std::swap(keys, right.keys);
+		std::swap(count, right.count);
+		std::swap(mask, right.mask);
+		std::swap(myHash, right.myHash);
+		std::swap(myEqual, right.myEqual);
+	}
+
+	// return number of keys
+	size_type size() const
+	{
+		return static_cast<size_type>(count);
+	}
+
+	// return number of buckets
+	size_type bucket_count() const
+	{
+		return static_cast<size_type>(mask + 1);
+	}
+
+	// return a pointer to the key equal to k in the mapping, or end()
+	iterator find(const T& k) const
+	{
+		if (offsets == nullptr)
+			return end();
+
+		uint64_t b = static_cast<uint64_t>(myHash(k)) & mask;
+		const T* last = keys + offsets[b + 1];
+		for (const T* p = keys + offsets[b]; p != last; ++p)
+			if (myEqual(*p, k))
+				return p;
+		return end();
+	}
+
+	// return the pointer find returns for a missing key
+	iterator end() const
+	{
+		return nullptr;
+	}
+
+	bool contains(const T& k) const
+	{
+		return find(k) != end();
+	}
+
+private:
+	struct Header
+	{
+		char magic[8];         // snapshotMagic
+		uint32_t version;      // snapshotVersion
+		uint32_t keySize;      // sizeof(T)
+		uint32_t keyAlign;     // alignof(T)
+		uint32_t byteOrder;    // snapshotByteOrder as stored by the writer
+		uint64_t count;        // number of keys
+		uint64_t bucketCount;  // a power of 2
+		uint64_t offsetsAt;    // file offset of the bucket offsets
+		uint64_t keysAt;       // file offset of the keys
+		uint64_t checksum;     // FNV-1a of the fields above
+	};
+
+	static constexpr char snapshotMagic[8] = { 'H', 'S', 'E', 'T', 'S', 'N', 'A', 'P' };
+	static const uint32_t snapshotVersion = 1;
+	static const uint32_t snapshotByteOrder = 0x01020304;
+
+	[[noreturn]] static void fail(const char* what)
+	{
+		throw std::system_error(errno, std::generic_category(),
+			std::string("set_snapshot: ") + what);
+	}
+
+	static uint64_t checksum(const Header& header)
+	{
+		return fnv1aBytes(&header, offsetof(Header, checksum));
+	}
+
+	// round offset up to a multiple of 64, which is at least alignof(T) for keys
+	// that are not over-aligned
+	static uint64_t alignUp(uint64_t offset, uint64_t alignment)
+	{
+		if (alignment < 64)
+			alignment = 64;
+		return (offset + alignment - 1) / alignment * alignment;
+	}
+
+	// lay out count keys, passed to a visitor by forEach, in a file at path:
+	// the file is written in place through a mapping, flushed, and renamed over path
+	template< class ForEach >
+	static void build(const std::string& path, size_type count, const Hash& hash, ForEach forEach)
+	{
+		Header header = {};
+		std::memcpy(header.magic, snapshotMagic, sizeof(header.magic));
+		header.version = snapshotVersion;
+		header.keySize = sizeof(T);
+		header.keyAlign = alignof(T);
+		header.byteOrder = snapshotByteOrder;
+		header.count = count;
+		header.bucketCount = 1;
+		while (header.bucketCount * 2 < count)
+			header.bucketCount *= 2;
+		header.offsetsAt = alignUp(sizeof(Header), 64);
+		header.keysAt = alignUp(header.offsetsAt + (header.bucketCount + 1) * sizeof(uint64_t), alignof(T));
+		header.checksum = checksum(header);
+		uint64_t total = header.keysAt + count * sizeof(T);
+		uint64_t bucketMask = header.bucketCount - 1;
+
+		// counting sort by bucket: first the bucket sizes, then each bucket's start
+		std::vector< uint64_t > next(header.bucketCount + 1, 0);
+		forEach([&](const T& key)
+		{
+			next[(static_cast<uint64_t>(hash(key)) & bucketMask) + 1]++;
+		});
+		for (uint64_t b = 1; b <= header.bucketCount; b++)
+			next[b] += next[b - 1];
+
+		std::string temp = path + ".tmp";
+		int fd = ::open(temp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+		if (fd < 0)
+			fail("open");
+		unsigned char* file = nullptr;
+		try
+		{
+			// reserve the blocks now: writing a page of a sparse file through the
+			// mapping on a full disk raises SIGBUS instead of returning ENOSPC
+			int error = ::posix_fallocate(fd, 0, static_cast<off_t>(total));
+			if (error != 0)
+			{
+				errno = error;
+				fail("posix_fallocate");
+			}
+			void* mapping = ::mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (mapping == MAP_FAILED)
+				fail("mmap");
+			file = static_cast<unsigned char*>(mapping);
+
+			std::memcpy(file, &header, sizeof(header));
+			std::memcpy(file + header.offsetsAt, next.data(), next.size() * sizeof(uint64_t));
+			T* out = reinterpret_cast<T*>(file + header.keysAt);
+			forEach([&](const T& key)
+			{
+				std::memcpy(static_cast<void*>(&out[next[static_cast<uint64_t>(hash(key)) & bucketMask]++]),
+					&key, sizeof(T));
+			});
+
+			if (::msync(file, total, MS_SYNC) != 0)
+				fail("msync");
+			::munmap(file, total);
+			file = nullptr;
+			if (::fsync(fd) != 0)
+				fail("fsync");
+			if (::close(fd) != 0)
+			{
+				fd = -1;
+				fail("close");
+			}
+			fd = -1;
+			if (::rename(temp.c_str(), path.c_str()) != 0)
+				fail("rename");
+		}
+		catch (...)
+		{
+			if (file != nullptr)
+				::munmap(file, total);
+			if (fd >= 0)
+				::close(fd);
+			::unlink(temp.c_str());
+			throw;
+		}
+		syncDirectory(path);
+	}
+
+	// make the rename of path durable by flushing the directory holding it
+	static void syncDirectory(const std::string& path)
+	{
+		size_t slash = path.rfind('/');
+		std::string dir = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+		int fd = ::open(dir.c_str(), O_RDONLY);
+		if (fd < 0)
+			fail("open directory");
+		int result = ::fsync(fd);
+		::close(fd);
+		if (result != 0)
+			fail("fsync directory");
+	}
+
+	// check the header of the mapping and point offsets and keys into it
+	void attach(const std::string& path)
+	{
+		Header header;
+		std::memcpy(&header, base, sizeof(header));
+		if (std::memcmp(header.magic, snapshotMagic, sizeof(header.magic)) != 0
+			|| header.checksum != checksum(header))
+			throw std::runtime_error("set_snapshot: " + path + " is not a snapshot");
+		if (header.version != snapshotVersion || header.byteOrder != snapshotByteOrder
+			|| header.keySize != sizeof(T) || header.keyAlign != alignof(T))
+			throw std::runtime_error("set_snapshot: " + path + " was written for a different version, byte order or key type");
+
+		uint64_t buckets = header.bucketCount;
+		if (buckets == 0 || (buckets & (buckets - 1)) != 0
+			|| header.offsetsAt % sizeof(uint64_t) != 0 || header.keysAt % alignof(T) != 0
+			|| header.offsetsAt < sizeof(Header)
+			|| header.offsetsAt + (buckets + 1) * sizeof(uint64_t) > header.keysAt
+			|| header.keysAt > length || (length - header.keysAt) / sizeof(T) < header.count)
+			throw std::runtime_error("set_snapshot: " + path + " is truncated or malformed");
+
+		offsets = reinterpret_cast<const uint64_t*>(base + header.offsetsAt);
+		keys = reinterpret_cast<const T*>(base + header.keysAt);
+		count = header.count;
+		mask = buckets - 1;
+		if (offsets[0] != 0 || offsets[buckets] != count)
+			throw std::runtime_error("set_snapshot: " + path + " is truncated or malformed");
+
+		// the first key sits at the start of its bucket under the writer's hash
+		if (count != 0)
+		{
+			uint64_t b = static_cast<uint64_t>(myHash(keys[0])) & mask;
+			if (offsets[b] != 0 || offsets[b + 1] == 0)
+				throw std::runtime_error("set_snapshot: " + path + " was written with a different hash function");
+		}
+	}
+
+	const unsigned char* base; // the whole file, mapped read-only
+	size_t length;             // bytes mapped
+	const uint64_t* offsets;   // bucket_count() + 1 key indexes
+	const T* keys;             // size() keys grouped by bucket
+	uint64_t count;
+	uint64_t mask;             // bucket_count() - 1
+
+	Hash myHash;      // hash function object
+	KeyEqual myEqual; // key equality function object
+};
+
+template< class T, class Hash, class KeyEqual >
+constexpr char set_snapshot< T, Hash, KeyEqual >::snapshotMagic[8];
+
+#endif
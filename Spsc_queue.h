@@ -0,0 +1,234 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>  // std::atomic
+#include <cstddef> // size_t
+#include <new>     // ::operator new, ::operator delete, placement new
+#include <utility> // std::forward, std::move
+
+#include "Deque.h" // DequeBlockSize, dequeLog2
+
+// CLASS TEMPLATE spsc_queue
+// Bounded lock-free FIFO queue for exactly one producer thread and one consumer thread.
+// Like deque, the elements live in a circular map of blocks of BlockSize elements;
+// here the capacity is fixed, so the map and all blocks are allocated by the
+// constructor and nothing is allocated afterwards.
+// Positions are free-running counters: position pos is stored in block
+// (pos >> blockShift) & (mapSize - 1), at offset pos & blockMask.
+template< class Ty, size_t BlockSize = DequeBlockSize< Ty >::value >
+class spsc_queue
+{
+public:
+	using value_type = Ty;
+	using size_type  = size_t;
+
+	// construct a queue holding at least count elements;
+	// the capacity is rounded up to a power of 2 and to a whole number of blocks
+	explicit spsc_queue(size_type count)
+		: map(nullptr),
+		mapSize(1)
+	{
+		while (mapSize * blockSize < count)
+			mapSize *= 2;
+
+		map = new Ty * [mapSize]();
+		try
+		{
+			for (size_type i = 0; i < mapSize; i++)
+				map[i] = static_cast<Ty*>(::operator new(blockSize * sizeof(Ty)));
+		}
+		catch (...)
+		{
+			freeBlocks();
+			throw;
+		}
+	}
+
+	spsc_queue(const spsc_queue&) = delete;
+	spsc_queue& operator=(const spsc_queue&) = delete;
+
+	// destroy the remaining elements and release the blocks;
+	// neither thread may be using the queue any more
+	~spsc_queue()
+	{
+		size_type tail = myTail.load(std::memory_order_relaxed);
+		for (size_type pos = myHead.load(std::memory_order_relaxed); pos != tail; ++pos)
+			slot(pos)->~Ty();
+		freeBlocks();
+	}
+
+	// return the maximum number of elements the queue can hold
+	size_type capacity() const
+	{
+		return mapSize * blockSize;
+	}
+
+	// return the number of elements; exact only when called by the producer
+	// or the consumer while the other thread is idle
+	size_type size() const
+	{
+		return myTail.load(std::memory_order_acquire) - myHead.load(std::memory_order_acquire);
+	}
+
+	// test if the queue is empty; same caveat as size
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// producer: append val; returns false if the queue is full
+	bool try_push(const Ty& val)
+	{
+		return try_emplace(val);
+	}
+
+	bool try_push(Ty&& val)
+	{
+		return try_emplace(std::move(val));
+	}
+
+	// producer: append an element constructed in place from args;
+	// returns false, constructing nothing, if the queue is full
+	template< class... Args >
+	bool try_emplace(Args&&... args)
+	{
+		size_type tail = myTail.load(std::memory_order_relaxed);
+		if (tail - cachedHead == capacity())
+		{
+			cachedHead = myHead.load(std::memory_order_acquire);
+			if (tail - cachedHead == capacity())
+				return false;
+		}
+
+		::new (static_cast<void*>(slot(tail))) Ty(std::forward< Args >(args)...);
+		myTail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// producer: append up to count elements copied from first, first + 1, ...
+	// returns the number of elements appended, which are published together
+	template< class InIt >
+	size_type try_push_n(InIt first, size_type count)
+	{
+		size_type tail = myTail.load(std::memory_order_relaxed);
+		if (capacity() - (tail - cachedHead) < count)
+			cachedHead = myHead.load(std::memory_order_acquire);
+
+		size_type space = capacity() - (tail - cachedHead);
+		if (count > space)
+			count = space;
+
+		size_type done = 0;
+		try
+		{
+			while (done < count)
+			{	// construct one block run at a time
+				Ty* dest = slot(tail + done);
+				size_type len = runLength(tail + done, count - done);
+				for (Ty* destLast = dest + len; dest != destLast; ++dest, ++first)
+				{
+					::new (static_cast<void*>(dest)) Ty(*first);
+					++done;
+				}
+			}
+		}
+		catch (...)
+		{
+			myTail.store(tail + done, std::memory_order_release);
+			throw;
+		}
+
+		myTail.store(tail + count, std::memory_order_release);
+		return count;
+	}
+
+	// consumer: move the first element into val and remove it;
+	// returns false if the queue is empty
+	bool try_pop(Ty& val)
+	{
+		size_type head = myHead.load(std::memory_order_relaxed);
+		if (head == cachedTail)
+		{
+			cachedTail = myTail.load(std::memory_order_acquire);
+			if (head == cachedTail)
+				return false;
+		}
+
+		Ty* elem = slot(head);
+		val = std::move(*elem);
+		elem->~Ty();
+		myHead.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer: move up to count elements to dest, dest + 1, ... and remove them;
+	// returns the number of elements removed
+	template< class OutIt >
+	size_type try_pop_n(OutIt dest, size_type count)
+	{
+		size_type head = myHead.load(std::memory_order_relaxed);
+		if (cachedTail - head < count)
+			cachedTail = myTail.load(std::memory_order_acquire);
+
+		size_type avail = cachedTail - head;
+		if (count > avail)
+			count = avail;
+
+		size_type done = 0;
+		while (done < count)
+		{	// drain one block run at a time
+			Ty* first = slot(head + done);
+			size_type len = runLength(head + done, count - done);
+			for (Ty* last = first + len; first != last; ++first, ++dest)
+			{
+				*dest = std::move(*first);
+				first->~Ty();
+			}
+			done += len;
+		}
+
+		myHead.store(head + count, std::memory_order_release);
+		return count;
+	}
+
+private:
+	static const size_type blockSize  = BlockSize;
+	static const size_type blockShift = dequeLog2(BlockSize);
+	static const size_type blockMask  = BlockSize - 1;
+
+	static_assert((blockSize & blockMask) == 0, "spsc_queue block size must be a power of 2");
+
+	// return the storage of position pos
+	Ty* slot(size_type pos) const
+	{
+		return map[(pos >> blockShift) & (mapSize - 1)] + (pos & blockMask);
+	}
+
+	// return the number of positions, at most count, from pos to the end of its block
+	static size_type runLength(size_type pos, size_type count)
+	{
+		size_type len = blockSize - (pos & blockMask);
+		return len < count ? len : count;
+	}
+
+	// release the blocks and the map
+	void freeBlocks()
+	{
+		for (size_type i = 0; i < mapSize; i++)
+			::operator delete(map[i]);
+		delete[] map;
+	}
+
+	Ty** map;          // pointer to array of pointers to blocks, never reallocated
+	size_type mapSize; // size of map array, 2^N
+
+	// consumer side: position of the first element, and the last tail it saw
+	alignas(64) std::atomic< size_type > myHead{ 0 };
+	size_type cachedTail = 0;
+
+	// producer side: position past the last element, and the last head it saw
+	alignas(64) std::atomic< size_type > myTail{ 0 };
+	size_type cachedHead = 0;
+};
+
+#endif
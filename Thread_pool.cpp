@@ -0,0 +1,161 @@
+#include "Thread_pool.h" // thread_pool class definition
+
+thread_local thread_pool *thread_pool::currentPool = nullptr;
+thread_local size_t thread_pool::currentIndex = 0;
+
+// Starts count worker threads (at least one).
+thread_pool::thread_pool(size_t count)
+	: stopping(false),
+	pending(0),
+	sleeping(0)
+{
+	if (count == 0)
+		count = 1;
+
+	workers.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		workers.emplace_back(new Worker);
+
+	try
+	{
+		for (size_t i = 0; i < count; i++)
+			workers[i]->thread = std::thread(&thread_pool::workerLoop, this, i);
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
+} // end constructor
+
+// Runs every pending task, then stops and joins the workers.
+thread_pool::~thread_pool()
+{
+	stop();
+} // end destructor
+
+// Returns the number of worker threads.
+size_t thread_pool::size() const
+{
+	return workers.size();
+}
+
+// Lets the workers finish the pending tasks, then joins them.
+void thread_pool::stop()
+{
+	{
+		std::lock_guard< std::mutex > lock(injectionMutex);
+		stopping = true;
+	}
+	idle.notify_all();
+
+	for (size_t i = 0; i < workers.size(); i++)
+		if (workers[i]->thread.joinable())
+			workers[i]->thread.join();
+}
+
+// Makes task visible to the workers and wakes one if any is asleep.
+// pending is raised before the task is published and sleeping is raised
+// before a worker rechecks pending, so one side always sees the other.
+void thread_pool::push(Task *task)
+{
+	pending.fetch_add(1);
+	try
+	{
+		if (currentPool == this)
+			workers[currentIndex]->tasks.push_back(task);
+		else
+		{
+			std::lock_guard< std::mutex > lock(injectionMutex);
+			injection.push_back(task);
+		}
+	}
+	catch (...)
+	{
+		pending.fetch_sub(1);
+		delete task;
+		throw;
+	}
+
+	if (sleeping.load() > 0)
+	{
+		std::lock_guard< std::mutex > lock(injectionMutex);
+		idle.notify_one();
+	}
+}
+
+// Takes a task: own deque first, then the injection queue, then steals.
+thread_pool::Task *thread_pool::take()
+{
+	Task *task = nullptr;
+	size_t self = currentPool == this ? currentIndex : workers.size();
+
+	if (self < workers.size() && workers[self]->tasks.pop_back(task))
+	{
+		pending.fetch_sub(1);
+		return task;
+	}
+
+	{
+		std::lock_guard< std::mutex > lock(injectionMutex);
+		if (!injection.empty())
+		{
+			task = injection.front();
+			injection.pop_front();
+			pending.fetch_sub(1);
+			return task;
+		}
+	}
+
+	// start with the next worker so thieves spread over the victims
+	for (size_t i = 1; i <= workers.size(); i++)
+	{
+		size_t victim = (self + i) % workers.size();
+		if (victim != self && workers[victim]->tasks.steal(task))
+		{
+			pending.fetch_sub(1);
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+// Takes and runs one task; returns false if none was found.
+bool thread_pool::runOne()
+{
+	std::unique_ptr< Task > task(take());
+	if (!task)
+		return false;
+
+	(*task)();
+	return true;
+}
+
+// Body of worker thread index: run tasks until the pool stops and none are left.
+void thread_pool::workerLoop(size_t index)
+{
+	currentPool = this;
+	currentIndex = index;
+
+	for (;;)
+	{
+		if (runOne())
+			continue;
+
+		std::unique_lock< std::mutex > lock(injectionMutex);
+		if (stopping && pending.load() == 0)
+			break;
+
+		// a task may be in flight between pending and its deque; spin rather than sleep
+		if (pending.load() > 0)
+		{
+			lock.unlock();
+			std::this_thread::yield();
+			continue;
+		}
+
+		sleeping.fetch_add(1);
+		idle.wait(lock, [this] { return stopping || pending.load() > 0; });
+		sleeping.fetch_sub(1);
+	}
+}
@@ -0,0 +1,105 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // size_t
+#include <functional>         // std::function
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex
+#include <thread>             // std::thread
+#include <utility>            // std::forward
+#include <vector>             // std::vector
+
+#include "Deque.h"               // include definition of class template deque
+#include "Work_stealing_deque.h" // include definition of class template work_stealing_deque
+
+// thread_pool class definition
+// Fork/join scheduler with one work_stealing_deque per worker.
+// A task submitted from a worker goes to the back of that worker's deque and is
+// popped from there first (LIFO, cache-warm); a task submitted from any other thread
+// goes to a shared injection queue. An idle worker drains the injection queue,
+// then steals from the front of the other workers' deques, then sleeps.
+class thread_pool
+{
+public:
+	// Starts count worker threads (at least one).
+	explicit thread_pool(size_t count = std::thread::hardware_concurrency());
+
+	// Runs every pending task, then stops and joins the workers.
+	~thread_pool();
+
+	thread_pool(const thread_pool &) = delete;
+	thread_pool& operator=(const thread_pool &) = delete;
+
+	// Returns the number of worker threads.
+	size_t size() const;
+
+	// Schedules func() to run on some worker.
+	// An exception escaping a task run by a worker terminates the program.
+	template< typename Func >
+	void submit(Func &&func);
+
+	// Runs pending tasks on the calling thread until done() returns true;
+	// a task waiting for the tasks it forked calls this instead of blocking.
+	template< typename Pred >
+	void run_until(Pred done);
+
+private:
+	using Task = std::function< void() >;
+
+	struct Worker
+	{
+		work_stealing_deque< Task * > tasks;
+		std::thread thread;
+	};
+
+	std::vector< std::unique_ptr< Worker > > workers;
+
+	std::mutex injectionMutex;     // guards injection, stopping and the idle wait
+	deque< Task * > injection;     // tasks submitted from outside the pool
+	std::condition_variable idle;  // signalled when a task arrives or the pool stops
+	bool stopping;
+
+	std::atomic< size_t > pending;  // tasks submitted and not yet taken
+	std::atomic< size_t > sleeping; // workers waiting on idle
+
+	// The pool and worker index of the calling thread, if it is a worker.
+	static thread_local thread_pool *currentPool;
+	static thread_local size_t currentIndex;
+
+	// Makes task visible to the workers and wakes one if any is asleep.
+	void push(Task *task);
+
+	// Takes a task: own deque first, then the injection queue, then steals.
+	// Returns nullptr if none was found.
+	Task *take();
+
+	// Takes and runs one task; returns false if none was found.
+	bool runOne();
+
+	// Lets the workers finish the pending tasks, then joins them.
+	void stop();
+
+	// Body of worker thread index.
+	void workerLoop(size_t index);
+}; // end class thread_pool
+
+
+// Schedules func() to run on some worker.
+template< typename Func >
+void thread_pool::submit(Func &&func)
+{
+	push(new Task(std::forward< Func >(func)));
+}
+
+// Runs pending tasks on the calling thread until done() returns true.
+template< typename Pred >
+void thread_pool::run_until(Pred done)
+{
+	while (!done())
+		if (!runOne())
+			std::this_thread::yield();
+}
+
+#endif
@@ -1,20 +1,139 @@
 #ifndef UNORDERED_SET
 #define UNORDERED_SET
-#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
 #include <vector>
+#include "Hash.h" // fast_hash, fnv1a_hash
+#include "List.h" // include definition of class template list
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h> // _mm_prefetch
+#endif
 using std::vector;
-using std::pow;
 
 unsigned int maxValue = 99;
 
+// Health report of an unordered_set, filled in by unordered_set::stats.
+// The shape fields come from a scan of the table made by the call itself.
+// The counters are kept by every operation only when UNORDERED_SET_STATS is
+// defined, and are 0 otherwise; define it in every translation unit or none,
+// since it changes the layout of unordered_set.
+struct unordered_set_stats
+{
+	unsigned int size = 0;
+	unsigned int bucket_count = 0;
+
+	// histogram[n] is the number of chains holding n elements; the last entry
+	// counts every chain of histogram.size() - 1 elements or more
+	vector< unsigned int > histogram;
+
+	unsigned int max_chain = 0;     // elements in the longest chain
+	double average_chain = 0;       // elements per nonempty chain
+	double collision_rate = 0;      // fraction of elements sharing a chain with an earlier one
+	unsigned int hash_collisions = 0; // elements whose full hash equals another element's
+
+	unsigned long long rehashes = 0;   // tables allocated by growth or rehash
+	double rehash_seconds = 0;         // time spent allocating tables and moving buckets
+	unsigned long long lookups = 0;    // bucket lookups by find, insert, erase and extract
+	unsigned long long probes = 0;     // elements compared by those lookups
+	double average_probe = 0;          // probes / lookups
+};
+
+// Hints the cache to load the line holding p; does nothing where unsupported.
+inline void prefetchRead(const void* p)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(p);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	_mm_prefetch(static_cast<const char*>(p), _MM_HINT_T0);
+#else
+	(void)p;
+#endif
+}
+
 // unordered_set class template definition
-template< typename T >
+// The elements of each bucket are kept contiguous in myList, so a lookup hashes
+// the key once and scans only that bucket's range. Iterators are list nodes:
+// the element is p->myVal and the next one is p->next.
+// Hash maps a key to size_t and KeyEqual compares keys; fast_hash is the default,
+// and fnv1a_hash matches the old FNV hashSeq for unsigned int keys below 2^31.
+// Growing the table relinks the existing nodes into the new buckets; nothing is
+// copied. With incremental rehashing on, the old buckets are kept and moved a few
+// at a time by each insert and erase, so no single insert pays for the whole table.
+template< typename T, typename Hash = fast_hash< T >, typename KeyEqual = std::equal_to< T > >
 class unordered_set
 {
 public:
 	using iterator = typename list< T >::iterator;
 
-	unordered_set();
+	// Node handle: owns the list node of an element taken out of a set by
+	// extract until it is inserted into a set or dropped; the element is not
+	// moved. Inserted back into the set it came from, the node is relinked as it
+	// is. Any other set moves the element into a node of its own, so that no set
+	// keeps another set's node blocks alive. A handle keeps the block of its node
+	// alive until it is inserted or dropped.
+	class node_type
+	{
+	public:
+		node_type() = default;
+
+		node_type(node_type&& other)
+			: myNode(other.myNode)
+		{
+			other.myNode = nullptr;
+		}
+
+		node_type& operator=(node_type&& other)
+		{
+			if (this != &other)
+			{
+				if (myNode != nullptr)
+					list< T >::dispose(myNode);
+				myNode = other.myNode;
+				other.myNode = nullptr;
+			}
+			return *this;
+		}
+
+		// Destroys the element held, if any.
+		~node_type()
+		{
+			if (myNode != nullptr)
+				list< T >::dispose(myNode);
+		}
+
+		// Returns true if the handle holds no element.
+		bool empty() const
+		{
+			return myNode == nullptr;
+		}
+
+		explicit operator bool() const
+		{
+			return myNode != nullptr;
+		}
+
+		// Returns the element; the handle must not be empty.
+		T& value()
+		{
+			return myNode->myVal;
+		}
+
+	private:
+		friend class unordered_set;
+
+		explicit node_type(iterator node)
+			: myNode(node)
+		{
+		}
+
+		iterator myNode = nullptr;
+	};
+
+	explicit unordered_set(const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual());
 
 	~unordered_set();
 
@@ -22,19 +141,60 @@ public:
 	unsigned int size() const;
 
 	// Searches the container for an element with k as value and
-	// returns an iterator to it if found, otherwise it returns myList.end()
+	// returns an iterator to it if found, otherwise it returns end()
 	iterator find(const T& k);
 
+	// Returns the first element, or end() if the container is empty; the
+	// elements are visited by following p->next until end().
+	iterator begin();
+
+	// Returns the iterator find returns for a missing element.
+	iterator end();
+
+	// Returns the hash function object.
+	Hash hash_function() const;
+
 	// Inserts a new element in the unordered_set.
 	// The element is inserted only if it is not equivalent to any other element
 	// already in the container ( elements in an unordered_set have unique values ).
 	// This effectively increases the container size by one.
 	void insert(const T& val);
 
+	// Inserts the element held by node unless an equivalent one is present.
+	// Returns true, leaving node empty, if it was inserted; otherwise node
+	// keeps its element.
+	bool insert(node_type&& node);
+
+	// Moves every element of other that is not in this set into it, leaving
+	// the duplicates in other. Each element is moved, never copied, into a node
+	// of this set, and its node goes back to other's free list.
+	void merge(unordered_set& other);
+
+	// Batched forms of find and insert for count keys at keys. Keys are taken
+	// in groups: every key of a group is hashed and its bucket prefetched, then
+	// the bucket heads are read and the first nodes prefetched, and only then are
+	// the keys resolved, so the cache misses of one group overlap. This pays once
+	// the table outgrows the cache; while it fits, the extra pass makes them
+	// slower than a loop of find (benchmarks/unordered_set_batch_bench.cpp).
+	// find_many stores find(keys[i]) in results[i]; contains_many stores whether
+	// keys[i] is present.
+	void find_many(const T* keys, size_t count, iterator* results);
+	void contains_many(const T* keys, size_t count, bool* results);
+	void insert_many(const T* keys, size_t count);
+
 	// Removes from the unordered_set container a single element.
 	// This effectively reduces the container size by one.
 	void erase(const T& k);
 
+	// Removes the element at position, which must be a valid element of this
+	// set; its hash is computed once and no key comparison is made.
+	void erase(iterator position);
+
+	// Removes the element equivalent to k, or the one at position, and returns
+	// it in a node handle; the handle is empty if k is not present.
+	node_type extract(const T& k);
+	node_type extract(iterator position);
+
 	// Returns the number of buckets in the unordered_set container.
 	unsigned int bucket_count() const;
 
@@ -42,8 +202,46 @@ public:
 	unsigned int bucket_size(unsigned int n) const;
 
 	// Returns the bucket number where the element with value k is located.
+	// While an incremental rehash is in progress, bucket and bucket_size describe
+	// the new table, which holds only the elements moved so far.
 	unsigned int bucket(const T& k) const;
 
+	// Returns the average number of elements per bucket.
+	float load_factor() const;
+
+	// Returns the load factor that makes insert grow the table (1 by default).
+	float max_load_factor() const;
+
+	// Sets the maximum load factor to f, rehashing at once if the current load
+	// exceeds it. Throws std::invalid_argument unless f is positive.
+	void max_load_factor(float f);
+
+	// Sets the number of buckets to at least buckets, and to at least enough for
+	// size() elements at the maximum load factor, rounded up to a power of 2.
+	// The table may shrink.
+	void rehash(unsigned int buckets);
+
+	// Makes room for n elements at the maximum load factor, so that inserting up
+	// to n elements does not rehash.
+	void reserve(unsigned int n);
+
+	// Selects incremental rehashing (off by default). When on, growing the table
+	// keeps the old buckets, and every insert or erase moves a couple of them to
+	// the new table until none are left.
+	void incremental_rehash(bool on);
+
+	// Moves every bucket still waiting in the old table to the new one.
+	void finish_rehash();
+
+	// Reports the chain histogram, chain lengths and collisions of the table,
+	// scanning every bucket and hashing every element, plus the counters kept
+	// under UNORDERED_SET_STATS. During an incremental rehash the old buckets
+	// not moved yet are reported as chains of their own.
+	unordered_set_stats stats(unsigned int histogramSize = 16) const;
+
+	// Zeroes the counters kept under UNORDERED_SET_STATS.
+	void reset_stats();
+
 	// Returns true iff the current object is equal to data
 	bool operator==(std::unordered_set< T >& data);
 
@@ -57,105 +255,415 @@ private:
 
 	unsigned int maxidx = 8; // current maximum key value, must be a power of 2
 
-	// put a new element in the unordered_set when myVec is large enough
-	void putIn(const T& val);
+	Hash myHash;      // hash function object
+	KeyEqual myEqual; // key equality function object
+
+	// Table being rehashed from, laid out like myVec. While oldMaxidx is not 0,
+	// old buckets migrateNext through oldMaxidx - 1 still hold their elements.
+	// Every bucket range in either table stays contiguous in myList.
+	vector< iterator > oldVec;
+	unsigned int oldMaxidx = 0;
+	unsigned int migrateNext = 0;
+	bool incremental = false;
+
+	float maxLoad = 1.0f; // maximum load factor
+
+#ifdef UNORDERED_SET_STATS
+	unsigned long long rehashCount = 0;
+	std::chrono::steady_clock::duration rehashTime{};
+	unsigned long long lookupCount = 0;
+	unsigned long long probeCount = 0;
+#endif
+
+	// Adds the chain [first, last] of vec's bucket b to report.
+	void countChain(const vector< iterator >& vec, unsigned int b, unordered_set_stats& report) const;
+
+	static const unsigned int migrateStep = 2; // old buckets moved per insert or erase
+	static const unsigned int maxBuckets = 1u << 30; // largest maxidx; 2 * maxidx still fits in unsigned int
+
+	// Returns the node holding k in bucket b of vec, or myList.end() if there is none.
+	iterator findInBucket(const vector< iterator >& vec, const T& k, unsigned int b);
+
+	// Looks up k with hash h in the new table, then in its old bucket if that
+	// has not been moved yet; vec and b are set to the bucket searched last.
+	iterator lookup(const T& k, size_t h, vector< iterator >*& vec, unsigned int& b);
+
+	static const size_t batchSize = 16; // keys per group in the batched members
+
+	// Returns false if an element equal to k, whose hash is h, is present.
+	// Otherwise advances any incremental rehash and grows a full table, so that
+	// an element of hash h can be placed in bucket h % maxidx, and returns true.
+	bool makeRoom(const T& k, size_t h);
 
-	// Computes hash value which will be used to compute bucket number
-	unsigned int hashSeq(const unsigned int& key, unsigned int count) const;
+	// Inserts val, whose hash is h, unless it is present; returns true if inserted.
+	template< typename V >
+	bool insertHashed(V&& val, size_t h);
+
+	// Sets vec and b to the bucket holding node p, whose hash is h.
+	void locate(iterator p, size_t h, vector< iterator >*& vec, unsigned int& b);
+
+	// Returns true if node p lies in bucket b of vec.
+	bool inBucket(const vector< iterator >& vec, unsigned int b, iterator p) const;
+
+	// Hashes keys[0, count) into hashes and prefetches their bucket heads, then
+	// prefetches the first node of every nonempty bucket; count <= batchSize.
+	void prefetchBatch(const T* keys, size_t count, size_t* hashes);
+
+	// put a new element in bucket b when myVec is large enough
+	template< typename V >
+	void putIn(V&& val, unsigned int b);
+
+	// Links node p, already in myList, into bucket b of myVec.
+	void relink(iterator p, unsigned int b);
+
+	// Links node p, unlinked from myList, back into myList and bucket b of myVec.
+	void linkIn(iterator p, unsigned int b);
+
+	// Unlinks node p from bucket b of vec without erasing it.
+	void removeFromBucket(vector< iterator >& vec, unsigned int b, iterator p);
+
+	// Returns the smallest power of 2, and at least 8, of buckets that holds
+	// n elements at the maximum load factor.
+	unsigned int bucketsFor(unsigned int n) const;
+
+	// Switches to a table of newMax buckets, after finishing any rehash in progress.
+	void grow(unsigned int newMax);
+
+	// Moves up to count old buckets to the new table.
+	void migrate(unsigned int count);
 }; // end class template unordered_set
 
 
-template< typename T >
-unordered_set< T >::unordered_set()
+template< typename T, typename Hash, typename KeyEqual >
+unordered_set< T, Hash, KeyEqual >::unordered_set(const Hash& hash, const KeyEqual& equal)
+	: myHash(hash),
+	myEqual(equal)
 {
 	myVec.reserve(16);
 	myVec.assign(16, myList.end());
 }
 
-template< typename T >
-unordered_set< T >::~unordered_set()
+template< typename T, typename Hash, typename KeyEqual >
+unordered_set< T, Hash, KeyEqual >::~unordered_set()
 {
 	myList.clear();
 	myVec.clear();
 }
 
-template< typename T >
-unsigned int unordered_set< T >::size() const
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int unordered_set< T, Hash, KeyEqual >::size() const
 {
 	return myList.size();
 }
 
-template< typename T >
-typename unordered_set< T >::iterator unordered_set< T >::find(const T& k)
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::iterator unordered_set< T, Hash, KeyEqual >::find(const T& k)
+{
+	vector< iterator >* vec;
+	unsigned int b;
+	return lookup(k, myHash(k), vec, b);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::iterator unordered_set< T, Hash, KeyEqual >::begin()
+{
+	return myList.begin();
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::iterator unordered_set< T, Hash, KeyEqual >::end()
 {
-	iterator p1 = myList.begin();
-	for (; p1 != myList.end(); ++p1)
-		if (*p1 == k)
-			return p1;
 	return myList.end();
 }
 
-template< typename T >
-void unordered_set< T >::insert(const T& val)
+template< typename T, typename Hash, typename KeyEqual >
+Hash unordered_set< T, Hash, KeyEqual >::hash_function() const
+{
+	return myHash;
+}
+
+// Scans the closed range [vec[2b], vec[2b+1]] of bucket b.
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::iterator unordered_set< T, Hash, KeyEqual >::findInBucket(const vector< iterator >& vec, const T& k, unsigned int b)
+{
+	iterator p1 = vec[b * 2];
+	if (p1 == myList.end())
+		return myList.end();
+
+	iterator last = vec[b * 2 + 1];
+	for (;; p1 = p1->next)
+	{
+#ifdef UNORDERED_SET_STATS
+		probeCount++;
+#endif
+		if (myEqual(p1->myVal, k))
+			return p1;
+		if (p1 == last)
+			return myList.end();
+	}
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::iterator unordered_set< T, Hash, KeyEqual >::lookup(const T& k, size_t h, vector< iterator >*& vec, unsigned int& b)
 {
-	if (find(val) != myList.end())
+#ifdef UNORDERED_SET_STATS
+	lookupCount++;
+#endif
+	vec = &myVec;
+	b = static_cast<unsigned int>(h % maxidx);
+	iterator p1 = findInBucket(myVec, k, b);
+	if (p1 != myList.end() || oldMaxidx == 0)
+		return p1;
+
+	unsigned int oldB = static_cast<unsigned int>(h % oldMaxidx);
+	if (oldB < migrateNext)
+		return p1;
+
+	vec = &oldVec;
+	b = oldB;
+	return findInBucket(oldVec, k, b);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::insert(const T& val)
+{
+	insertHashed(val, myHash(val));
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+bool unordered_set< T, Hash, KeyEqual >::makeRoom(const T& k, size_t h)
+{
+	vector< iterator >* vec;
+	unsigned int b;
+	if (lookup(k, h, vec, b) != myList.end())
+		return false;
+
+	migrate(migrateStep);
+	if (size() >= maxLoad * maxidx && maxidx < maxBuckets)
+		grow((maxidx < 512) ? maxidx * 8 : maxidx * 2);
+	return true;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+template< typename V >
+bool unordered_set< T, Hash, KeyEqual >::insertHashed(V&& val, size_t h)
+{
+	if (!makeRoom(val, h))
+		return false;
+	putIn(std::forward< V >(val), static_cast<unsigned int>(h % maxidx));
+	return true;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+bool unordered_set< T, Hash, KeyEqual >::insert(node_type&& node)
+{
+	if (node.empty())
+		return false;
+
+	size_t h = myHash(node.myNode->myVal);
+	if (!makeRoom(node.myNode->myVal, h))
+		return false;
+	unsigned int b = static_cast<unsigned int>(h % maxidx);
+	if (myList.owns(node.myNode))
+		linkIn(node.myNode, b);
+	else
+	{	// a foreign node would keep its whole block alive here
+		putIn(std::move(node.myNode->myVal), b);
+		list< T >::dispose(node.myNode);
+	}
+	node.myNode = nullptr;
+	return true;
+}
+
+// other is first brought out of any incremental rehash, so its nodes stay put
+// while its list is walked. Relinking other's nodes instead would let a few
+// merged elements keep other's blocks allocated after other is gone.
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::merge(unordered_set& other)
+{
+	if (&other == this)
 		return;
 
-	if (size() == bucket_count())
+	other.finish_rehash();
+	iterator p1 = other.myList.begin();
+	while (p1 != other.myList.end())
+	{
+		iterator next = p1->next;
+		size_t h = myHash(p1->myVal);
+		if (makeRoom(p1->myVal, h))
+		{
+			unsigned int b = static_cast<unsigned int>(other.myHash(p1->myVal) % other.maxidx);
+			putIn(std::move(p1->myVal), static_cast<unsigned int>(h % maxidx));
+			other.removeFromBucket(other.myVec, b, p1);
+			other.myList.erase(p1);
+		}
+		p1 = next;
+	}
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::find_many(const T* keys, size_t count, iterator* results)
+{
+	size_t hashes[batchSize];
+	for (size_t first = 0; first < count; first += batchSize)
 	{
-		int newMax = (maxidx < 512) ? maxidx * 8 : maxidx * 2;
-		vector< iterator > newVec;
-		newVec.reserve(newMax * 2);
-		newVec.assign(newMax * 2, myList.end());
-
-		list< T > newList;
-		iterator p1 = myList.begin();
-		for (; p1 != myList.end(); ++p1)
-			newList.insert(newList.end(), *p1);
-
-		myVec.clear();
-		myVec = newVec;
-		maxidx = newMax;
-		myList.clear();
-
-		for (p1 = newList.begin(); p1 != newList.end(); ++p1)
-			putIn(*p1);
+		size_t n = (count - first < batchSize) ? count - first : batchSize;
+		prefetchBatch(keys + first, n, hashes);
+
+		vector< iterator >* vec;
+		unsigned int b;
+		for (size_t i = 0; i < n; i++)
+			results[first + i] = lookup(keys[first + i], hashes[i], vec, b);
 	}
-	putIn(val);
 }
 
-template< typename T >
-void unordered_set< T >::erase(const T& k)
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::contains_many(const T* keys, size_t count, bool* results)
 {
-	if (find(k) == myList.end())
+	size_t hashes[batchSize];
+	for (size_t first = 0; first < count; first += batchSize)
+	{
+		size_t n = (count - first < batchSize) ? count - first : batchSize;
+		prefetchBatch(keys + first, n, hashes);
+
+		vector< iterator >* vec;
+		unsigned int b;
+		for (size_t i = 0; i < n; i++)
+			results[first + i] = lookup(keys[first + i], hashes[i], vec, b) != myList.end();
+	}
+}
+
+// A group's prefetches are wasted if one of its inserts grows the table;
+// reserve first when the batch size is known.
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::insert_many(const T* keys, size_t count)
+{
+	size_t hashes[batchSize];
+	for (size_t first = 0; first < count; first += batchSize)
+	{
+		size_t n = (count - first < batchSize) ? count - first : batchSize;
+		prefetchBatch(keys + first, n, hashes);
+
+		for (size_t i = 0; i < n; i++)
+			insertHashed(keys[first + i], hashes[i]);
+	}
+}
+
+// Only the new table is prefetched; during an incremental rehash a key
+// in an unmoved old bucket costs an ordinary miss.
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::prefetchBatch(const T* keys, size_t count, size_t* hashes)
+{
+	for (size_t i = 0; i < count; i++)
+	{
+		hashes[i] = myHash(keys[i]);
+		prefetchRead(&myVec[(hashes[i] % maxidx) * 2]);
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		iterator p1 = myVec[(hashes[i] % maxidx) * 2];
+		if (p1 != myList.end())
+			prefetchRead(p1);
+	}
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::erase(const T& k)
+{
+	vector< iterator >* vec;
+	unsigned int b;
+	iterator p1 = lookup(k, myHash(k), vec, b);
+	if (p1 == myList.end())
 		return;
 
-	int b = bucket(k);
-	iterator p1 = find(k);
+	removeFromBucket(*vec, b, p1);
+	myList.erase(p1);
+	migrate(migrateStep);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::erase(iterator position)
+{
+	vector< iterator >* vec;
+	unsigned int b;
+	locate(position, myHash(position->myVal), vec, b);
+	removeFromBucket(*vec, b, position);
+	myList.erase(position);
+	migrate(migrateStep);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::node_type unordered_set< T, Hash, KeyEqual >::extract(const T& k)
+{
+	vector< iterator >* vec;
+	unsigned int b;
+	iterator p1 = lookup(k, myHash(k), vec, b);
+	if (p1 == myList.end())
+		return node_type();
+
+	removeFromBucket(*vec, b, p1);
+	node_type node(myList.unlink(p1));
+	migrate(migrateStep);
+	return node;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+typename unordered_set< T, Hash, KeyEqual >::node_type unordered_set< T, Hash, KeyEqual >::extract(iterator position)
+{
+	vector< iterator >* vec;
+	unsigned int b;
+	locate(position, myHash(position->myVal), vec, b);
+
+	removeFromBucket(*vec, b, position);
+	node_type node(myList.unlink(position));
+	migrate(migrateStep);
+	return node;
+}
 
-	if (myVec[b * 2] == myVec[b * 2 + 1])
+// An element whose old bucket is not moved yet is in the old table, unless it
+// was inserted during the rehash; those always go to the new table.
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::locate(iterator p, size_t h, vector< iterator >*& vec, unsigned int& b)
+{
+	vec = &myVec;
+	b = static_cast<unsigned int>(h % maxidx);
+	if (oldMaxidx == 0)
+		return;
+
+	unsigned int oldB = static_cast<unsigned int>(h % oldMaxidx);
+	if (oldB >= migrateNext && !inBucket(myVec, b, p))
 	{
-		myVec[b * 2] = myVec[b * 2 + 1] = myList.end();
+		vec = &oldVec;
+		b = oldB;
 	}
-	else
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+bool unordered_set< T, Hash, KeyEqual >::inBucket(const vector< iterator >& vec, unsigned int b, iterator p) const
+{
+	iterator p1 = vec[b * 2];
+	if (p1 == myList.end())
+		return false;
+
+	for (iterator last = vec[b * 2 + 1];; p1 = p1->next)
 	{
-		if (p1 == myVec[b * 2])
-			myVec[b * 2] = ++p1;
-		else if (p1 == myVec[b * 2 + 1])
-			myVec[b * 2 + 1] = --p1;
+		if (p1 == p)
+			return true;
+		if (p1 == last)
+			return false;
 	}
-	myList.erase(find(k));
 }
 
-template< typename T >
-unsigned int unordered_set< T >::bucket_count() const
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int unordered_set< T, Hash, KeyEqual >::bucket_count() const
 {
 	return maxidx;
 }
 
 // return size of bucket n
-template< typename T >
-unsigned int unordered_set< T >::bucket_size(unsigned int n) const
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int unordered_set< T, Hash, KeyEqual >::bucket_size(unsigned int n) const
 {
 	if (myVec[n * 2] == myList.end())
 		return 0;
@@ -163,90 +671,290 @@ unsigned int unordered_set< T >::bucket_size(unsigned int n) const
 	int count = 1;
 	iterator p1 = myVec[n * 2];
 	iterator p2 = myVec[n * 2 + 1];
-	for (; p1 != p2; ++p1)
+	for (; p1 != p2; p1 = p1->next)
 		count++;
 
 	return count;
 }
 
-template< typename T >
-unsigned int unordered_set< T >::bucket(const T& k) const
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int unordered_set< T, Hash, KeyEqual >::bucket(const T& k) const
+{
+	return static_cast<unsigned int>(myHash(k) % maxidx); // bucket number
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+float unordered_set< T, Hash, KeyEqual >::load_factor() const
+{
+	return static_cast<float>(size()) / maxidx;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+float unordered_set< T, Hash, KeyEqual >::max_load_factor() const
 {
-	unsigned int hashValue = hashSeq(k, sizeof(T));
-	return hashValue % maxidx; // bucket number
+	return maxLoad;
 }
 
-template< typename T >
-void unordered_set< T >::putIn(const T& val)
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::max_load_factor(float f)
 {
-	int b = bucket(val);
+	if (!(f > 0)) // also rejects NaN
+		throw std::invalid_argument("unordered_set::max_load_factor: load factor must be positive");
+	maxLoad = f;
+	if (size() > maxLoad * maxidx)
+		rehash(0);
+}
 
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::rehash(unsigned int buckets)
+{
+	unsigned int newMax = bucketsFor(size());
+	while (newMax < buckets && newMax < maxBuckets)
+		newMax *= 2;
+	if (newMax != maxidx)
+		grow(newMax);
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::reserve(unsigned int n)
+{
+	if (n > maxLoad * maxidx)
+		rehash(bucketsFor(n));
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+unsigned int unordered_set< T, Hash, KeyEqual >::bucketsFor(unsigned int n) const
+{
+	double needed = n / static_cast<double>(maxLoad);
+	unsigned int buckets = 8;
+	while (buckets < needed && buckets < maxBuckets)
+		buckets *= 2;
+	return buckets;
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::incremental_rehash(bool on)
+{
+	incremental = on;
+	if (!on)
+		finish_rehash();
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::finish_rehash()
+{
+	if (oldMaxidx != 0)
+		migrate(oldMaxidx - migrateNext);
+}
+
+// An empty bucket starts at the end of myList; otherwise val becomes the
+// first element of its bucket, so the bucket stays contiguous.
+template< typename T, typename Hash, typename KeyEqual >
+template< typename V >
+void unordered_set< T, Hash, KeyEqual >::putIn(V&& val, unsigned int b)
+{
+	if (myVec[b * 2] == myList.end())
+		myVec[b * 2] = myVec[b * 2 + 1] = myList.insert(myList.end(), std::forward< V >(val));
+	else
+		myVec[b * 2] = myList.insert(myVec[b * 2], std::forward< V >(val));
+}
+
+// Same placement as putIn. Nodes only ever land at the end of myList or just
+// before the first node of a new bucket, so no old bucket range is split.
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::relink(iterator p, unsigned int b)
+{
 	if (myVec[b * 2] == myList.end())
 	{
-		myList.insert(myList.end(), val);
-		myVec[b * 2] = --myList.end();
-		myVec[b * 2 + 1] = --myList.end();
+		myList.splice(myList.end(), p);
+		myVec[b * 2] = myVec[b * 2 + 1] = p;
 	}
 	else
 	{
-		myList.insert(myVec[b * 2], val);
-		myVec[b * 2] = find(val);
+		myList.splice(myVec[b * 2], p);
+		myVec[b * 2] = p;
 	}
 }
 
-template< typename T >
-unsigned int unordered_set< T >::hashSeq(const unsigned int& key, unsigned int count) const
+// Same placement as relink, for a node not in myList.
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::linkIn(iterator p, unsigned int b)
 {
-	long long int h = 2166136261;
-	int prime = 16777619;
-	int buffer = key;
-
-	vector<int> data;
-	vector<int> arrhash;
+	if (myVec[b * 2] == myList.end())
+	{
+		myList.link(myList.end(), p);
+		myVec[b * 2] = myVec[b * 2 + 1] = p;
+	}
+	else
+	{
+		myList.link(myVec[b * 2], p);
+		myVec[b * 2] = p;
+	}
+}
 
-	while (buffer > 0)
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::removeFromBucket(vector< iterator >& vec, unsigned int b, iterator p)
+{
+	if (vec[b * 2] == vec[b * 2 + 1])
 	{
-		data.push_back(buffer % 2);
-		buffer /= 2;
+		vec[b * 2] = vec[b * 2 + 1] = myList.end();
 	}
-	data.resize(32, 0);
+	else
+	{
+		if (p == vec[b * 2])
+			vec[b * 2] = p->next;
+		else if (p == vec[b * 2 + 1])
+			vec[b * 2 + 1] = p->prev;
+	}
+}
 
-	for (int i = 0; i < 4; i++)
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::grow(unsigned int newMax)
+{
+	finish_rehash();
+#ifdef UNORDERED_SET_STATS
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	rehashCount++;
+#endif
+
+	// allocate first, so a bad_alloc leaves the table as it was
+	vector< iterator > newVec(static_cast<size_t>(newMax) * 2, myList.end());
+	oldVec.swap(myVec);
+	myVec.swap(newVec);
+	oldMaxidx = maxidx;
+	migrateNext = 0;
+	maxidx = newMax;
+#ifdef UNORDERED_SET_STATS
+	rehashTime += std::chrono::steady_clock::now() - start;
+#endif
+
+	if (!incremental)
+		finish_rehash();
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::migrate(unsigned int count)
+{
+	if (oldMaxidx == 0)
+		return;
+#ifdef UNORDERED_SET_STATS
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+#endif
+
+	for (; count > 0 && oldMaxidx != 0; count--)
 	{
-		arrhash.clear();
-		while (h > 0)
+		unsigned int oldB = migrateNext++;
+		iterator p1 = oldVec[oldB * 2];
+		if (p1 != myList.end())
 		{
-			arrhash.push_back(h % 2);
-			h /= 2;
+			iterator last = oldVec[oldB * 2 + 1];
+			for (bool done = false; !done; )
+			{	// relink moves p1, so step first
+				iterator next = p1->next;
+				done = (p1 == last);
+				relink(p1, bucket(p1->myVal));
+				p1 = next;
+			}
 		}
-		arrhash.resize(32, 0);
 
-		for (int j = 0; j < 8; j++)
+		if (migrateNext == oldMaxidx)
 		{
-			if (data[i * 8 + j] == 1 && arrhash[j] == 1)
-				arrhash[j] = 0;
-			else if (data[i * 8 + j] == 1 && arrhash[j] == 0)
-				arrhash[j] = 1;
+			vector< iterator >().swap(oldVec);
+			oldMaxidx = 0;
+			migrateNext = 0;
 		}
+	}
+#ifdef UNORDERED_SET_STATS
+	rehashTime += std::chrono::steady_clock::now() - start;
+#endif
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+unordered_set_stats unordered_set< T, Hash, KeyEqual >::stats(unsigned int histogramSize) const
+{
+	unordered_set_stats report;
+	report.size = size();
+	report.bucket_count = maxidx;
+	report.histogram.assign(histogramSize < 2 ? 2 : histogramSize, 0);
+
+	for (unsigned int b = 0; b < maxidx; b++)
+		countChain(myVec, b, report);
+	for (unsigned int b = migrateNext; b < oldMaxidx; b++)
+		countChain(oldVec, b, report);
+
+	unsigned int chains = 0;
+	for (size_t n = 1; n < report.histogram.size(); n++)
+		chains += report.histogram[n];
+	if (chains != 0)
+		report.average_chain = static_cast<double>(report.size) / chains;
+	if (report.size != 0)
+		report.collision_rate = static_cast<double>(report.size - chains) / report.size;
+
+	// equal full hashes collide in a table of any size
+	vector< size_t > hashes;
+	hashes.reserve(report.size);
+	for (const ListNode< T >* p1 = myList.begin(); p1 != myList.end(); p1 = p1->next)
+		hashes.push_back(myHash(p1->myVal));
+	std::sort(hashes.begin(), hashes.end());
+	for (size_t i = 0; i < hashes.size(); )
+	{
+		size_t j = i + 1;
+		while (j < hashes.size() && hashes[j] == hashes[i])
+			j++;
+		if (j - i > 1)
+			report.hash_collisions += static_cast<unsigned int>(j - i);
+		i = j;
+	}
+
+#ifdef UNORDERED_SET_STATS
+	report.rehashes = rehashCount;
+	report.rehash_seconds = std::chrono::duration< double >(rehashTime).count();
+	report.lookups = lookupCount;
+	report.probes = probeCount;
+	if (lookupCount != 0)
+		report.average_probe = static_cast<double>(probeCount) / lookupCount;
+#endif
+	return report;
+}
 
-		h = 0;
-		for (int i = 0; i < 32; i++)
-			if (arrhash[i] != 0)
-				h += pow(2, i);
-		h = (h * prime) % 4294967296;
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::reset_stats()
+{
+#ifdef UNORDERED_SET_STATS
+	rehashCount = 0;
+	rehashTime = std::chrono::steady_clock::duration();
+	lookupCount = 0;
+	probeCount = 0;
+#endif
+}
+
+template< typename T, typename Hash, typename KeyEqual >
+void unordered_set< T, Hash, KeyEqual >::countChain(const vector< iterator >& vec, unsigned int b, unordered_set_stats& report) const
+{
+	unsigned int length = 0;
+	iterator p1 = vec[b * 2];
+	if (p1 != myList.end())
+	{
+		length = 1;
+		for (iterator last = vec[b * 2 + 1]; p1 != last; p1 = p1->next)
+			length++;
 	}
 
-	return h;
+	size_t slot = length < report.histogram.size() ? length : report.histogram.size() - 1;
+	report.histogram[slot]++;
+	if (length > report.max_chain)
+		report.max_chain = length;
 }
 
-template< typename T >
-bool unordered_set< T >::operator==(std::unordered_set< T >& data)
+template< typename T, typename Hash, typename KeyEqual >
+bool unordered_set< T, Hash, KeyEqual >::operator==(std::unordered_set< T >& data)
 {
+	finish_rehash();
 	if (myList.size() != data.size())
 		return false;
 
 	unsigned int* firstVec = *(reinterpret_cast<unsigned int**>(&data) + 5);
-	vector< list< T >::iterator >::iterator it = myVec.begin();
+	typename vector< iterator >::iterator it = myVec.begin();
 	for (unsigned int bucketNo = 0; it != myVec.end(); ++it, bucketNo++)
 	{
 		if (data.bucket_size(bucketNo) != bucket_size(bucketNo))
@@ -255,29 +963,29 @@ bool unordered_set< T >::operator==(std::unordered_set< T >& data)
 		unsigned int* stlBucketFirst = *(reinterpret_cast<unsigned int**>(&firstVec[2 * bucketNo]));
 		unsigned int* stlBucketLast = *(reinterpret_cast<unsigned int**>(&firstVec[2 * bucketNo + 1]));
 
-		list< T >::iterator myBucketFirst = *it;
+		iterator myBucketFirst = *it;
 		++it;
-		list< T >::iterator myBucketLast = *it;
+		iterator myBucketLast = *it;
 		if (myBucketFirst != myList.end())
 		{
 			if (myBucketFirst == myBucketLast)
 			{
-				if (*myBucketFirst != *(stlBucketFirst + 2))
+				if (myBucketFirst->myVal != *(stlBucketFirst + 2))
 					return false;
 			}
 			else
 			{
 				unsigned int* stlPtr = stlBucketFirst;
-				list< T >::iterator myIt = myBucketFirst;
+				iterator myIt = myBucketFirst;
 				while (myIt != myBucketLast)
 				{
-					if (*myIt != *(stlPtr + 2))
+					if (myIt->myVal != *(stlPtr + 2))
 						return false;
 					stlPtr = *(reinterpret_cast<unsigned int**>(stlPtr));
-					++myIt;
+					myIt = myIt->next;
 				}
 
-				if (*myBucketLast != *(stlBucketLast + 2))
+				if (myBucketLast->myVal != *(stlBucketLast + 2))
 					return false;
 			}
 		}
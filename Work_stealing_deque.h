@@ -0,0 +1,251 @@
+#ifndef WORK_STEALING_DEQUE_H
+#define WORK_STEALING_DEQUE_H
+
+#include <atomic>      // std::atomic, std::atomic_thread_fence
+#include <cstddef>     // size_t, ptrdiff_t
+#include <type_traits> // std::is_trivially_copyable
+#include <vector>      // std::vector
+
+#include "Deque.h" // DequeBlockSize, dequeLog2
+
+// CLASS TEMPLATE work_stealing_deque
+// Chase-Lev deque: one owner thread pushes and pops at the back,
+// any number of thief threads steal from the front.
+// Like deque, the elements live in a circular map of blocks of BlockSize elements,
+// indexed by free-running positions: position pos is stored in block
+// (pos >> blockShift) & (mapSize - 1), at offset pos & blockMask.
+// When the owner finds the map full it doubles it. A thief may still be reading
+// through the old map, so every block that holds a live element keeps that element
+// at the same slot in the new map (only a block the live range wraps around into
+// is copied), and old maps and blocks are released only by the destructor.
+// Elements are copied with relaxed atomic loads and stores, so Ty must be
+// trivially copyable; task schedulers store pointers.
+template< class Ty, size_t BlockSize = DequeBlockSize< Ty >::value >
+class work_stealing_deque
+{
+public:
+	using value_type = Ty;
+	using size_type  = size_t;
+
+	static_assert(std::is_trivially_copyable< Ty >::value,
+		"work_stealing_deque requires a trivially copyable element type");
+
+	// construct an empty deque holding one block
+	work_stealing_deque()
+		: myTop(0),
+		myBottom(0),
+		myMap(nullptr)
+	{
+		myMap.store(newMap(1), std::memory_order_relaxed);
+		allBlocks.reserve(1);
+		myMap.load(std::memory_order_relaxed)->blocks[0] = buyBlock();
+	}
+
+	work_stealing_deque(const work_stealing_deque&) = delete;
+	work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+	// release every map and block; no thread may be using the deque any more
+	~work_stealing_deque()
+	{
+		for (BlockMap* map : allMaps)
+		{
+			delete[] map->blocks;
+			delete map;
+		}
+		for (Block block : allBlocks)
+			delete[] block;
+	}
+
+	// return the number of elements at the time of the call; approximate
+	// while other threads are stealing
+	size_type size() const
+	{
+		ptrdiff_t bottom = myBottom.load(std::memory_order_relaxed);
+		ptrdiff_t top = myTop.load(std::memory_order_relaxed);
+		return bottom > top ? static_cast<size_type>(bottom - top) : 0;
+	}
+
+	// test if the deque was empty at the time of the call
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	// owner: insert val at the back, doubling the map if it is full
+	void push_back(const Ty& val)
+	{
+		ptrdiff_t bottom = myBottom.load(std::memory_order_relaxed);
+		ptrdiff_t top = myTop.load(std::memory_order_acquire);
+		BlockMap* map = myMap.load(std::memory_order_relaxed);
+
+		if (static_cast<size_type>(bottom - top) >= map->mapSize * blockSize)
+		{
+			map = growMap(map, top, bottom);
+			myMap.store(map, std::memory_order_release);
+		}
+
+		slot(map, bottom)->store(val, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		myBottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+
+	// owner: move the last element into val and remove it;
+	// returns false if the deque is empty or a thief took the last element
+	bool pop_back(Ty& val)
+	{
+		ptrdiff_t bottom = myBottom.load(std::memory_order_relaxed) - 1;
+		BlockMap* map = myMap.load(std::memory_order_relaxed);
+		myBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		ptrdiff_t top = myTop.load(std::memory_order_relaxed);
+
+		if (top > bottom)
+		{	// empty, restore bottom
+			myBottom.store(bottom + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		val = slot(map, bottom)->load(std::memory_order_relaxed);
+		if (top == bottom)
+		{	// last element, race the thieves for it
+			bool won = myTop.compare_exchange_strong(top, top + 1,
+				std::memory_order_seq_cst, std::memory_order_relaxed);
+			myBottom.store(bottom + 1, std::memory_order_relaxed);
+			return won;
+		}
+		return true;
+	}
+
+	// any thread: move the first element into val and remove it;
+	// returns false if the deque is empty or another thread got there first
+	bool steal(Ty& val)
+	{
+		ptrdiff_t top = myTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		ptrdiff_t bottom = myBottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return false;
+
+		BlockMap* map = myMap.load(std::memory_order_acquire);
+		Ty elem = slot(map, top)->load(std::memory_order_relaxed);
+		if (!myTop.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed))
+			return false;
+
+		val = elem;
+		return true;
+	}
+
+private:
+	static const size_type blockSize  = BlockSize;
+	static const size_type blockShift = dequeLog2(BlockSize);
+	static const size_type blockMask  = BlockSize - 1;
+
+	static_assert((blockSize & blockMask) == 0, "work_stealing_deque block size must be a power of 2");
+
+	using Block = std::atomic< Ty >*;
+
+	struct BlockMap
+	{
+		Block* blocks;     // pointer to array of pointers to blocks
+		size_type mapSize; // size of blocks array, 2^N
+	};
+
+	// return the storage of position pos in map
+	static std::atomic< Ty >* slot(const BlockMap* map, ptrdiff_t pos)
+	{
+		size_type off = static_cast<size_type>(pos);
+		return map->blocks[(off >> blockShift) & (map->mapSize - 1)] + (off & blockMask);
+	}
+
+	// allocate a map of mapSize null block pointers and take ownership of it
+	BlockMap* newMap(size_type mapSize)
+	{
+		BlockMap* map = new BlockMap{ nullptr, mapSize };
+		try
+		{
+			map->blocks = new Block[mapSize]();
+			allMaps.push_back(map);
+		}
+		catch (...)
+		{
+			delete[] map->blocks;
+			delete map;
+			throw;
+		}
+		return map;
+	}
+
+	// allocate a block and take ownership of it; the caller has reserved
+	// room in allBlocks, so the push_back cannot throw and leak the block
+	Block buyBlock()
+	{
+		Block block = new std::atomic< Ty >[blockSize];
+		allBlocks.push_back(block);
+		return block;
+	}
+
+	// owner: build a map twice the size of oldMap holding positions [top, bottom)
+	BlockMap* growMap(BlockMap* oldMap, ptrdiff_t top, ptrdiff_t bottom)
+	{
+		size_type oldSize = oldMap->mapSize;
+		BlockMap* map = newMap(2 * oldSize);
+		allBlocks.reserve(allBlocks.size() + map->mapSize);
+
+		// a full deque spans oldSize + 1 blocks unless top is block-aligned;
+		// then the first and last blocks share one old block
+		std::vector< unsigned char > uses(oldSize);
+		size_type first = static_cast<size_type>(top) >> blockShift;
+		size_type last = static_cast<size_type>(bottom - 1) >> blockShift;
+		for (size_type block = first; block <= last; ++block)
+			++uses[block & (oldSize - 1)];
+
+		for (size_type block = first; block <= last; ++block)
+		{
+			Block oldBlock = oldMap->blocks[block & (oldSize - 1)];
+			Block& newBlock = map->blocks[block & (map->mapSize - 1)];
+			if (uses[block & (oldSize - 1)] == 1)
+			{	// keep the block, thieves see the same slots through either map
+				newBlock = oldBlock;
+				continue;
+			}
+
+			// shared block: copy both parts and retire it
+			newBlock = buyBlock();
+			ptrdiff_t pos = static_cast<ptrdiff_t>(block << blockShift);
+			ptrdiff_t end = pos + static_cast<ptrdiff_t>(blockSize);
+			if (pos < top)
+				pos = top;
+			if (end > bottom)
+				end = bottom;
+			for (; pos < end; ++pos)
+			{
+				size_type off = static_cast<size_type>(pos) & blockMask;
+				newBlock[off].store(oldBlock[off].load(std::memory_order_relaxed),
+					std::memory_order_relaxed);
+			}
+		}
+
+		// fill the remaining slots with the old blocks no live element uses
+		size_type spare = 0;
+		for (size_type i = 0; i < map->mapSize; i++)
+		{
+			if (map->blocks[i] != nullptr)
+				continue;
+			while (spare < oldSize && uses[spare] != 0)
+				++spare;
+			map->blocks[i] = spare < oldSize ? oldMap->blocks[spare++] : buyBlock();
+		}
+		return map;
+	}
+
+	alignas(64) std::atomic< ptrdiff_t > myTop;    // position of the first element, advanced by thieves
+	alignas(64) std::atomic< ptrdiff_t > myBottom; // position past the last element, owner only
+	std::atomic< BlockMap* > myMap;                // current map, replaced by the owner when full
+
+	std::vector< BlockMap* > allMaps; // every map ever built, owner only
+	std::vector< Block > allBlocks;   // every block ever allocated, owner only
+};
+
+#endif
@@ -0,0 +1,122 @@
+// Stress test and scaling benchmark for concurrent_forward_list.
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -mcx16 -pthread benchmarks/concurrent_forward_list_bench.cpp -latomic
+// Run with an optional thread count (default: hardware threads).
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Concurrent_forward_list.h"
+#include "../Forward_list.h"
+
+// Producers push distinct values while consumers pop them one at a time and
+// with pop_all; every value must come out exactly once.
+static bool stress(unsigned int threads)
+{
+	const unsigned int perProducer = 200000;
+	unsigned int producers = threads > 1 ? threads / 2 : 1;
+	unsigned int consumers = threads > 1 ? threads - producers : 1;
+	unsigned int total = producers * perProducer;
+
+	concurrent_forward_list< unsigned int > stack;
+	std::vector< std::atomic< unsigned char > > seen(total);
+	std::atomic< unsigned int > popped(0);
+	std::atomic< bool > duplicate(false);
+
+	auto take = [&](unsigned int value)
+	{
+		if (seen[value].fetch_add(1) != 0)
+			duplicate = true;
+		popped.fetch_add(1);
+	};
+
+	std::vector< std::thread > pool;
+	for (unsigned int p = 0; p < producers; p++)
+		pool.emplace_back([&, p]
+		{
+			for (unsigned int i = 0; i < perProducer; i++)
+				stack.push_front(p * perProducer + i);
+		});
+	for (unsigned int c = 0; c < consumers; c++)
+		pool.emplace_back([&, c]
+		{
+			unsigned int value;
+			while (popped.load() < total)
+			{
+				if (c == 0 && popped.load() % 64 == 0)
+					stack.pop_all(take);
+				else if (stack.pop_front(value))
+					take(value);
+			}
+		});
+	for (std::thread &t : pool)
+		t.join();
+
+	return !duplicate && popped.load() == total && stack.empty();
+}
+
+// Each thread pushes and pops its own values in pairs for a fixed time;
+// returns millions of push/pop pairs per second.
+template< typename Push, typename Pop >
+static double pairsPerSecond(unsigned int threads, Push push, Pop pop)
+{
+	const unsigned int pairs = 1000000;
+	std::vector< std::thread > pool;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int t = 0; t < threads; t++)
+		pool.emplace_back([&, t]
+		{
+			for (unsigned int i = 0; i < pairs; i++)
+			{
+				push(t);
+				pop();
+			}
+		});
+	for (std::thread &t : pool)
+		t.join();
+	double seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+	return threads * pairs / seconds / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int maxThreads = argc > 1 ? static_cast< unsigned int >(std::atoi(argv[1]))
+		: std::thread::hardware_concurrency();
+	if (maxThreads == 0)
+		maxThreads = 1;
+
+	concurrent_forward_list< unsigned int > probe;
+	std::printf("%u hardware threads; head is_lock_free() = %d\n",
+		std::thread::hardware_concurrency(), probe.is_lock_free());
+
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+		if (!stress(threads))
+		{
+			std::printf("stress test FAILED with %u threads\n", threads);
+			return 1;
+		}
+	std::printf("stress test passed up to %u threads\n", maxThreads);
+
+	std::printf("threads  concurrent_forward_list  mutex+forward_list  (M push/pop pairs per s)\n");
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+	{
+		concurrent_forward_list< unsigned int > stack;
+		double lockFree = pairsPerSecond(threads,
+			[&](unsigned int v) { stack.push_front(v); },
+			[&] { unsigned int v; stack.pop_front(v); });
+
+		std::mutex mutex;
+		forward_list< unsigned int > list;
+		double locked = pairsPerSecond(threads,
+			[&](unsigned int v) { std::lock_guard< std::mutex > guard(mutex); list.push_front(v); },
+			[&] { std::lock_guard< std::mutex > guard(mutex); if (!list.empty()) list.pop_front(); });
+
+		std::printf("%7u  %23.2f  %18.2f\n", threads, lockFree, locked);
+	}
+	return 0;
+}
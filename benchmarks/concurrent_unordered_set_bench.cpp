@@ -0,0 +1,137 @@
+// Scaling benchmark for concurrent_unordered_set against unordered_set behind
+// one mutex: a read-only mix and a mix with 10% inserts and erases.
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread benchmarks/concurrent_unordered_set_bench.cpp
+// Run with an optional thread count (default: hardware threads).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../Concurrent_unordered_set.h"
+#include "../Unordered_set.h"
+
+const unsigned int preloaded = 1000000; // shared keys 0, 2, 4, ..., all present
+const unsigned int opsPerThread = 2000000;
+const unsigned int ownKeys = 4096;      // odd keys private to each thread
+
+// Runs threads workers, each doing opsPerThread operations. Reads hit the
+// shared keys; one operation in writeEvery (if not 0) inserts or erases one of
+// the worker's own odd keys, whose final state the worker remembers in own.
+// Returns millions of operations per second.
+template< typename Contains, typename Insert, typename Erase >
+static double opsPerSecond(unsigned int threads, unsigned int writeEvery,
+	std::vector< std::vector< bool > > &own, Contains contains, Insert insert, Erase erase)
+{
+	std::vector< std::thread > pool;
+	std::vector< unsigned int > hits(threads);
+	own.assign(threads, std::vector< bool >(ownKeys, false));
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (unsigned int t = 0; t < threads; t++)
+		pool.emplace_back([&, t]
+		{
+			unsigned int x = 2463534242u + t * 7919u, found = 0;
+			for (unsigned int i = 0; i < opsPerThread; i++)
+			{
+				x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+				if (writeEvery != 0 && i % writeEvery == 0)
+				{
+					unsigned int slot = x % ownKeys;
+					unsigned int key = 2 * (t * ownKeys + slot) + 1;
+					if (own[t][slot])
+						erase(key);
+					else
+						insert(key);
+					own[t][slot] = !own[t][slot];
+				}
+				else
+					found += contains(2 * (x % preloaded));
+			}
+			hits[t] = found;
+		});
+	for (std::thread &t : pool)
+		t.join();
+	double seconds = std::chrono::duration< double >(std::chrono::steady_clock::now() - start).count();
+
+	for (unsigned int t = 0; t < threads; t++)
+		if (hits[t] != opsPerThread - (writeEvery ? (opsPerThread + writeEvery - 1) / writeEvery : 0))
+		{
+			std::printf("thread %u missed a preloaded key\n", t);
+			std::exit(1);
+		}
+	return threads * double(opsPerThread) / seconds / 1e6;
+}
+
+// Checks that every worker's own keys are present exactly when it left them so.
+template< typename Contains >
+static bool ownKeysMatch(const std::vector< std::vector< bool > > &own, Contains contains)
+{
+	for (unsigned int t = 0; t < own.size(); t++)
+		for (unsigned int slot = 0; slot < ownKeys; slot++)
+			if (contains(2 * (t * ownKeys + slot) + 1) != own[t][slot])
+				return false;
+	return true;
+}
+
+// Returns how many own keys the workers left present.
+static size_t ownCount(const std::vector< std::vector< bool > > &own)
+{
+	size_t n = 0;
+	for (const std::vector< bool > &keys : own)
+		for (bool present : keys)
+			n += present;
+	return n;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int maxThreads = argc > 1 ? static_cast< unsigned int >(std::atoi(argv[1]))
+		: std::thread::hardware_concurrency();
+	if (maxThreads == 0)
+		maxThreads = 1;
+
+	std::printf("%u hardware threads, %u preloaded keys, %u ops per thread\n",
+		std::thread::hardware_concurrency(), preloaded, opsPerThread);
+	std::printf("threads  mix          concurrent_unordered_set  mutex+unordered_set  (M ops per s)\n");
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2)
+		for (unsigned int writeEvery : { 0u, 10u })
+		{
+			std::vector< std::vector< bool > > own;
+
+			concurrent_unordered_set< unsigned int > shared;
+			for (unsigned int k = 0; k < preloaded; k++)
+				shared.insert(2 * k);
+			double lockFree = opsPerSecond(threads, writeEvery, own,
+				[&](unsigned int k) { return shared.contains(k); },
+				[&](unsigned int k) { shared.insert(k); },
+				[&](unsigned int k) { shared.erase(k); });
+			if (!ownKeysMatch(own, [&](unsigned int k) { return shared.contains(k); })
+				|| shared.size() != preloaded + ownCount(own))
+			{
+				std::printf("concurrent_unordered_set lost an update with %u threads\n", threads);
+				return 1;
+			}
+
+			std::mutex mutex;
+			unordered_set< unsigned int > set;
+			for (unsigned int k = 0; k < preloaded; k++)
+				set.insert(2 * k);
+			double locked = opsPerSecond(threads, writeEvery, own,
+				[&](unsigned int k) { std::lock_guard< std::mutex > guard(mutex); return set.find(k) != set.end(); },
+				[&](unsigned int k) { std::lock_guard< std::mutex > guard(mutex); set.insert(k); },
+				[&](unsigned int k) { std::lock_guard< std::mutex > guard(mutex); set.erase(k); });
+			if (!ownKeysMatch(own, [&](unsigned int k) { return set.find(k) != set.end(); })
+				|| set.size() != preloaded + ownCount(own))
+			{
+				std::printf("mutex+unordered_set lost an update with %u threads\n", threads);
+				return 1;
+			}
+
+			std::printf("%7u  %-11s  %24.2f  %19.2f\n", threads,
+				writeEvery ? "90% reads" : "reads only", lockFree, locked);
+		}
+	return 0;
+}
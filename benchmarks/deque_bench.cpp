@@ -0,0 +1,80 @@
+// Full-deque scans: the block-wise deque_* algorithms against the same scans
+// through deque's iterators and over std::deque.
+// Build from the repository root:
+//   g++ -std=c++17 -O2 benchmarks/deque_bench.cpp
+// Run with an optional element count (default 10000000).
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "../Deque.h"
+
+// Runs func reps times and returns the best time in milliseconds.
+template< typename Func >
+static double bestMs(Func func, int reps = 5)
+{
+	double best = 1e30;
+	for (int r = 0; r < reps; r++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		func();
+		double ms = std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - start).count();
+		if (ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+static volatile long long sink;
+
+int main(int argc, char **argv)
+{
+	size_t count = argc > 1 ? static_cast< size_t >(std::atoll(argv[1])) : 10000000;
+
+	deque< int > mine, mine2;
+	std::deque< int > theirs, theirs2;
+	for (size_t i = 0; i < count; i++)
+	{
+		int v = static_cast< int >(i * 2654435761u);
+		mine.push_back(v);
+		mine2.push_back(v);
+		theirs.push_back(v);
+		theirs2.push_back(v);
+	}
+	const deque< int > &cmine = mine;
+	std::vector< int > out(count);
+	int missing = -1;
+
+	std::printf("%zu ints, best of 5, ms    deque_*   deque iterators   std::deque\n", count);
+
+	std::printf("sum                    %8.2f  %16.2f  %11.2f\n",
+		bestMs([&] { long long sum = 0; deque_for_each(cmine, [&sum](int v) { sum += v; }); sink = sum; }),
+		bestMs([&] { long long sum = 0; for (auto it = cmine.begin(); it != cmine.end(); ++it) sum += *it; sink = sum; }),
+		bestMs([&] { long long sum = 0; for (int v : theirs) sum += v; sink = sum; }));
+
+	std::printf("copy                   %8.2f  %16.2f  %11.2f\n",
+		bestMs([&] { deque_copy(cmine, out.begin()); sink = out[count / 2]; }),
+		bestMs([&] { std::copy(cmine.begin(), cmine.end(), out.begin()); sink = out[count / 2]; }),
+		bestMs([&] { std::copy(theirs.begin(), theirs.end(), out.begin()); sink = out[count / 2]; }));
+
+	std::printf("equal                  %8.2f  %16.2f  %11.2f\n",
+		bestMs([&] { sink = deque_equal(mine, mine2); }),
+		bestMs([&] { sink = std::equal(cmine.begin(), cmine.end(), static_cast< const deque< int >& >(mine2).begin()); }),
+		bestMs([&] { sink = std::equal(theirs.begin(), theirs.end(), theirs2.begin()); }));
+
+	std::printf("lexicographical        %8.2f  %16.2f  %11.2f\n",
+		bestMs([&] { sink = deque_lexicographical_compare(mine, mine2); }),
+		bestMs([&] { sink = std::lexicographical_compare(cmine.begin(), cmine.end(),
+			static_cast< const deque< int >& >(mine2).begin(), static_cast< const deque< int >& >(mine2).end()); }),
+		bestMs([&] { sink = theirs < theirs2; }));
+
+	std::printf("find (missing)         %8.2f  %16.2f  %11.2f\n",
+		bestMs([&] { sink = deque_find(cmine, missing) == cmine.end(); }),
+		bestMs([&] { sink = std::find(cmine.begin(), cmine.end(), missing) == cmine.end(); }),
+		bestMs([&] { sink = std::find(theirs.begin(), theirs.end(), missing) == theirs.end(); }));
+	return 0;
+}
@@ -0,0 +1,194 @@
+// Fork/join benchmark: thread_pool (one work_stealing_deque per worker)
+// against a pool whose workers share one mutex-guarded task queue.
+// Build from the repository root:
+//   g++ -std=c++17 -O2 -pthread benchmarks/thread_pool_bench.cpp Thread_pool.cpp
+// Run with an optional worker count (default: hardware threads).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../Thread_pool.h"
+
+// The baseline: every submit and every take goes through one locked queue.
+class single_queue_pool
+{
+public:
+	explicit single_queue_pool(size_t count)
+		: stopping(false)
+	{
+		for (size_t i = 0; i < count; i++)
+			workers.emplace_back([this]
+			{
+				for (;;)
+				{
+					std::function< void() > task;
+					{
+						std::unique_lock< std::mutex > lock(mutex);
+						ready.wait(lock, [this] { return stopping || !tasks.empty(); });
+						if (tasks.empty())
+							return;
+						task = std::move(tasks.front());
+						tasks.pop_front();
+					}
+					task();
+				}
+			});
+	}
+
+	~single_queue_pool()
+	{
+		{
+			std::lock_guard< std::mutex > lock(mutex);
+			stopping = true;
+		}
+		ready.notify_all();
+		for (std::thread &t : workers)
+			t.join();
+	}
+
+	template< typename Func >
+	void submit(Func &&func)
+	{
+		{
+			std::lock_guard< std::mutex > lock(mutex);
+			tasks.emplace_back(std::forward< Func >(func));
+		}
+		ready.notify_one();
+	}
+
+	// runs queued tasks on the calling thread until done() holds
+	template< typename Pred >
+	void run_until(Pred done)
+	{
+		while (!done())
+		{
+			std::function< void() > task;
+			{
+				std::lock_guard< std::mutex > lock(mutex);
+				if (!tasks.empty())
+				{
+					task = std::move(tasks.front());
+					tasks.pop_front();
+				}
+			}
+			if (task)
+				task();
+			else
+				std::this_thread::yield();
+		}
+	}
+
+private:
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::deque< std::function< void() > > tasks;
+	bool stopping;
+	std::vector< std::thread > workers;
+};
+
+static long long fibSerial(int n)
+{
+	return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+// fib(n), forking one task per call down to the cutoff
+template< typename Pool >
+static long long fib(Pool &pool, int n, int cutoff)
+{
+	if (n <= cutoff)
+		return fibSerial(n);
+
+	long long left = 0;
+	std::atomic< bool > done(false);
+	pool.submit([&] { left = fib(pool, n - 1, cutoff); done.store(true, std::memory_order_release); });
+	long long right = fib(pool, n - 2, cutoff);
+	pool.run_until([&] { return done.load(std::memory_order_acquire); });
+	return left + right;
+}
+
+// quicksort of [first, last), forking the left half down to the cutoff
+template< typename Pool >
+static void quicksort(Pool &pool, int *first, int *last, ptrdiff_t cutoff)
+{
+	if (last - first <= cutoff)
+	{
+		std::sort(first, last);
+		return;
+	}
+
+	int pivot = first[(last - first) / 2];
+	int *middle1 = std::partition(first, last, [pivot](int v) { return v < pivot; });
+	int *middle2 = std::partition(middle1, last, [pivot](int v) { return !(pivot < v); });
+
+	std::atomic< bool > done(false);
+	pool.submit([&] { quicksort(pool, first, middle1, cutoff); done.store(true, std::memory_order_release); });
+	quicksort(pool, middle2, last, cutoff);
+	pool.run_until([&] { return done.load(std::memory_order_acquire); });
+}
+
+// runs func on a pool task and waits for it; returns milliseconds
+template< typename Pool, typename Func >
+static double timeOn(Pool &pool, Func func)
+{
+	std::atomic< bool > done(false);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	pool.submit([&] { func(); done.store(true, std::memory_order_release); });
+	pool.run_until([&] { return done.load(std::memory_order_acquire); });
+	return std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char **argv)
+{
+	size_t workers = argc > 1 ? static_cast< size_t >(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+	if (workers == 0)
+		workers = 1;
+
+	const int fibN = 36, fibCutoff = 14;
+	const size_t sortSize = 4000000;
+	const ptrdiff_t sortCutoff = 2048;
+
+	std::vector< int > input(sortSize);
+	std::mt19937 rng(1);
+	for (int &v : input)
+		v = static_cast< int >(rng());
+
+	std::printf("%zu workers (%u hardware threads), ms\n", workers, std::thread::hardware_concurrency());
+	std::printf("                         thread_pool   single queue\n");
+
+	long long expected = fibSerial(fibN);
+	double fibStealing, fibSingle, sortStealing, sortSingle;
+	long long got1 = 0, got2 = 0;
+	std::vector< int > data1 = input, data2 = input;
+	{
+		thread_pool pool(workers);
+		fibStealing = timeOn(pool, [&] { got1 = fib(pool, fibN, fibCutoff); });
+		sortStealing = timeOn(pool, [&] { quicksort(pool, data1.data(), data1.data() + data1.size(), sortCutoff); });
+	}
+	{
+		single_queue_pool pool(workers);
+		fibSingle = timeOn(pool, [&] { got2 = fib(pool, fibN, fibCutoff); });
+		sortSingle = timeOn(pool, [&] { quicksort(pool, data2.data(), data2.data() + data2.size(), sortCutoff); });
+	}
+
+	if (got1 != expected || got2 != expected || !std::is_sorted(data1.begin(), data1.end())
+		|| !std::is_sorted(data2.begin(), data2.end()))
+	{
+		std::printf("wrong result\n");
+		return 1;
+	}
+
+	std::printf("fib(%d), cutoff %d      %12.1f   %12.1f\n", fibN, fibCutoff, fibStealing, fibSingle);
+	std::printf("quicksort %zu ints   %12.1f   %12.1f\n", sortSize, sortStealing, sortSingle);
+	return 0;
+}
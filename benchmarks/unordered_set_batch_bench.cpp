@@ -0,0 +1,73 @@
+// Batched lookups: unordered_set::contains_many, which hashes a group of keys
+// and prefetches their buckets before probing, against a loop of find over the
+// same keys. Half the keys are present.
+// Build from the repository root:
+//   g++ -std=c++17 -O2 benchmarks/unordered_set_batch_bench.cpp
+// Run with an optional largest size (default 4194304).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../Unordered_set.h"
+
+// Runs func reps times and returns the best time in milliseconds.
+template< typename Func >
+static double bestMs(Func func, int reps = 3)
+{
+	double best = 1e30;
+	for (int r = 0; r < reps; r++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		func();
+		double ms = std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - start).count();
+		if (ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+int main(int argc, char **argv)
+{
+	size_t largest = argc > 1 ? static_cast< size_t >(std::atoll(argv[1])) : 4194304;
+	const size_t probes = 4194304;
+
+	std::printf("ns per key, best of 3       find loop   contains_many\n");
+	for (size_t count = 1024; count <= largest; count *= 8)
+	{
+		std::mt19937 random(1);
+		std::vector< unsigned int > keys(count);
+		for (unsigned int &k : keys)
+			k = random();
+		unordered_set< unsigned int > set;
+		set.insert_many(keys.data(), keys.size());
+
+		std::vector< unsigned int > queries(probes);
+		for (unsigned int &q : queries)
+			q = (random() & 1) ? keys[random() % count] : random();
+
+		// std::vector< bool > is packed, so results go to plain arrays
+		bool *looped = new bool[probes];
+		bool *batched = new bool[probes];
+		double loopMs = bestMs([&] {
+			for (size_t i = 0; i < probes; i++)
+				looped[i] = set.find(queries[i]) != set.end(); });
+		double batchMs = bestMs([&] {
+			set.contains_many(queries.data(), probes, batched); });
+
+		for (size_t i = 0; i < probes; i++)
+			if (looped[i] != batched[i])
+			{
+				std::printf("contains_many disagrees with find on key %u\n", queries[i]);
+				return 1;
+			}
+		delete[] looped;
+		delete[] batched;
+
+		double perKey = 1e6 / probes;
+		std::printf("%9zu elements  %16.1f  %14.1f\n", count, loopMs * perKey, batchMs * perKey);
+	}
+	return 0;
+}
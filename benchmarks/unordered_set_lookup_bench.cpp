@@ -0,0 +1,101 @@
+// Lookup time per key as unordered_set grows from 10^3 to 10^7 elements,
+// against std::unordered_set. Hits probe keys in the set in a scattered order,
+// misses probe keys that are not in it.
+// Build from the repository root:
+//   g++ -std=c++17 -O2 benchmarks/unordered_set_lookup_bench.cpp
+// Run with an optional largest size (default 10000000).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_set>
+#include <vector>
+
+#include "../Unordered_set.h"
+
+// Runs func reps times and returns the best time in milliseconds.
+template< typename Func >
+static double bestMs(Func func, int reps = 3)
+{
+	double best = 1e30;
+	for (int r = 0; r < reps; r++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		func();
+		double ms = std::chrono::duration< double, std::milli >(std::chrono::steady_clock::now() - start).count();
+		if (ms < best)
+			best = ms;
+	}
+	return best;
+}
+
+static volatile size_t sink;
+
+// Keys are odd so that every even number is a guaranteed miss.
+static unsigned int keyAt(size_t i)
+{
+	return static_cast< unsigned int >(i * 2654435761u) | 1u;
+}
+
+int main(int argc, char **argv)
+{
+	size_t largest = argc > 1 ? static_cast< size_t >(std::atoll(argv[1])) : 10000000;
+	const size_t probes = 2000000;
+
+	std::printf("ns per lookup, best of 3   unordered_set hit/miss   std::unordered_set hit/miss\n");
+	for (size_t count = 1000; count <= largest; count *= 10)
+	{
+		unordered_set< unsigned int > mine;
+		std::unordered_set< unsigned int > theirs;
+		for (size_t i = 0; i < count; i++)
+		{
+			mine.insert(keyAt(i));
+			theirs.insert(keyAt(i));
+		}
+
+		// every probe key is looked up once per run, in an order unrelated to insertion
+		std::vector< unsigned int > hits(probes), misses(probes);
+		for (size_t i = 0; i < probes; i++)
+		{
+			hits[i] = keyAt((i * 40503u) % count);
+			misses[i] = keyAt(i) & ~1u;
+		}
+
+		size_t found = 0;
+		double mineHit = bestMs([&] {
+			size_t n = 0;
+			for (unsigned int k : hits)
+				n += mine.find(k) != mine.end();
+			found = n; sink = n; });
+		if (found != probes)
+		{
+			std::printf("unordered_set missed %zu keys at size %zu\n", probes - found, count);
+			return 1;
+		}
+		double mineMiss = bestMs([&] {
+			size_t n = 0;
+			for (unsigned int k : misses)
+				n += mine.find(k) != mine.end();
+			found = n; sink = n; });
+		if (found != 0)
+		{
+			std::printf("unordered_set found %zu absent keys at size %zu\n", found, count);
+			return 1;
+		}
+		double theirHit = bestMs([&] {
+			size_t n = 0;
+			for (unsigned int k : hits)
+				n += theirs.count(k);
+			sink = n; });
+		double theirMiss = bestMs([&] {
+			size_t n = 0;
+			for (unsigned int k : misses)
+				n += theirs.count(k);
+			sink = n; });
+
+		double perLookup = 1e6 / probes;
+		std::printf("%9zu elements          %7.1f / %-7.1f          %7.1f / %-7.1f\n", count,
+			mineHit * perLookup, mineMiss * perLookup, theirHit * perLookup, theirMiss * perLookup);
+	}
+	return 0;
+}